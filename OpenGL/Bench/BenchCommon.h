@@ -0,0 +1,21 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <unistd.h>
+#include <climits>
+#include <string>
+
+// The benchmarks chdir into the asset directory, so paths given on the
+// command line are made absolute against the launch directory first
+inline std::string absolutePath(const std::string& path) {
+    if (path.empty() || path[0] == '/') {
+        return path;
+    }
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        return path;
+    }
+    return std::string(cwd) + "/" + path;
+}
+
+#endif // BENCH_COMMON_H
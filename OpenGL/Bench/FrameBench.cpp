@@ -0,0 +1,419 @@
+// Headless frame benchmark.
+//
+// Renders the same frame as the game loop in main.cpp (skybox, spheres, gun,
+// crosshair) into an offscreen framebuffer on a surfaceless EGL context, while
+// the camera follows a scripted path. Per-frame CPU submit time, GPU time and
+// wall time are reported as percentiles in JSON, along with the GL state calls
+// the render queue issued and skipped and the targets frustum culling kept and
+// dropped per frame. --respawns N moves, recolors and resizes N targets per
+// frame the way a hit does, inside the timed region.
+// --sky first draws the skybox before the opaque geometry instead of after it,
+// so comparing GPU time against the default shows the fill rate sky-last saves.
+// --draw fixed draws every target with the 36x18 mesh and --draw impostor with
+// ray-cast quads instead of the screen-size detail levels (--draw lod);
+// target triangles per frame are reported for each. --shape uv draws the
+// targets with UV spheres instead of icospheres of the same silhouette error.
+//
+//   FrameBench [--targets N] [--frames N] [--warmup N] [--width W] [--height H]
+//              [--respawns N] [--sky first|last] [--draw lod|fixed|impostor]
+//              [--shape ico|uv] [--seed S] [--assets DIR] [--out FILE] [--dump FILE.ppm]
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glm/glm.hpp>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Frame.h"
+#include "Log.h"
+#include "BenchCommon.h"
+
+#ifndef AIMLAB_ASSET_DIR
+#define AIMLAB_ASSET_DIR "."
+#endif
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace {
+
+struct Options {
+    int targets = 1;
+    int frames = 600;
+    int warmup = 60;
+    int width = 800;
+    int height = 600;
+    int respawns = 0;
+    std::string sky = "last";
+    std::string draw = "lod";
+    std::string shape = "ico";
+    unsigned int seed = 1234;
+    std::string assets = AIMLAB_ASSET_DIR;
+    std::string out;
+    std::string dump;
+};
+
+struct Stats {
+    double mean, min, p50, p90, p95, p99, max;
+};
+
+// Number of timer queries in flight before a result is read back
+const int QUERY_RING = 4;
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--targets") options.targets = std::atoi(value);
+        else if (arg == "--frames") options.frames = std::atoi(value);
+        else if (arg == "--warmup") options.warmup = std::atoi(value);
+        else if (arg == "--width") options.width = std::atoi(value);
+        else if (arg == "--height") options.height = std::atoi(value);
+        else if (arg == "--respawns") options.respawns = std::atoi(value);
+        else if (arg == "--sky") options.sky = value;
+        else if (arg == "--draw") options.draw = value;
+        else if (arg == "--shape") options.shape = value;
+        else if (arg == "--seed") options.seed = (unsigned int)std::strtoul(value, nullptr, 10);
+        else if (arg == "--assets") options.assets = value;
+        else if (arg == "--out") options.out = absolutePath(value);
+        else if (arg == "--dump") options.dump = absolutePath(value);
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return options.frames > 0 && options.targets >= 0 && options.width > 0 && options.height > 0 &&
+        options.respawns >= 0 && (options.sky == "first" || options.sky == "last") &&
+        (options.draw == "lod" || options.draw == "fixed" || options.draw == "impostor") &&
+        (options.shape == "ico" || options.shape == "uv");
+}
+
+// Creates a 3.3 core context without any surface (Mesa llvmpipe works)
+bool createHeadlessContext(EGLDisplay& display, EGLContext& context) {
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    display = EGL_NO_DISPLAY;
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::cerr << "Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE, 0,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        std::cerr << "No EGL config with desktop OpenGL support" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "Failed to bind the OpenGL API" << std::endl;
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create a 3.3 core context" << std::endl;
+        return false;
+    }
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "Failed to make the surfaceless context current" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Stats computeStats(std::vector<double> samples) {
+    Stats stats = {};
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        size_t index = (size_t)std::lround(p * (samples.size() - 1));
+        return samples[index];
+    };
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    stats.mean = sum / samples.size();
+    stats.min = samples.front();
+    stats.p50 = percentile(0.50);
+    stats.p90 = percentile(0.90);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+void writeStats(FILE* out, const char* name, const Stats& s, bool last) {
+    std::fprintf(out,
+        "    \"%s\": { \"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, "
+        "\"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+        name, s.mean, s.min, s.p50, s.p90, s.p95, s.p99, s.max, last ? "" : ",");
+}
+
+// Slow yaw sweep with a gentle pitch bob, standing at the spawn point
+Camera scriptedCamera(int frame, int frameCount) {
+    float phase = (float)frame / (float)frameCount;
+    Camera camera;
+    camera.position = glm::vec3(0.0f, 0.0f, 3.0f);
+    camera.up = glm::vec3(0.0f, 1.0f, 0.0f);
+    camera.yaw = -90.0f + 360.0f * phase;
+    camera.pitch = 20.0f * sinf(phase * 2.0f * 3.14159265f);
+
+    glm::vec3 front;
+    front.x = cos(glm::radians(camera.yaw)) * cos(glm::radians(camera.pitch));
+    front.y = sin(glm::radians(camera.pitch));
+    front.z = sin(glm::radians(camera.yaw)) * cos(glm::radians(camera.pitch));
+    camera.front = glm::normalize(front);
+    return camera;
+}
+
+// Writes the color attachment of the bound framebuffer as a binary PPM
+bool dumpFramebuffer(const std::string& path, int width, int height) {
+    std::vector<unsigned char> pixels(width * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int y = height - 1; y >= 0; --y) {
+        std::fwrite(&pixels[y * width * 3], 1, width * 3, file);
+    }
+    std::fclose(file);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: FrameBench [--targets N] [--frames N] [--warmup N] [--width W] "
+            "[--height H] [--respawns N] [--sky first|last] [--draw lod|fixed|impostor] "
+            "[--shape ico|uv] [--seed S] [--assets DIR] [--out FILE] [--dump FILE.ppm]" << std::endl;
+        return 2;
+    }
+
+    // Asset paths in the game are relative to the project directory
+    if (chdir(options.assets.c_str()) != 0) {
+        std::cerr << "Cannot enter asset directory " << options.assets << std::endl;
+        return 1;
+    }
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!createHeadlessContext(display, context)) {
+        return 1;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+
+    // Offscreen render target
+    unsigned int fbo, colorBuffer, depthBuffer;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, options.width, options.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return 1;
+    }
+    glViewport(0, 0, options.width, options.height);
+
+    std::vector<std::string> faces = {
+        "skybox/right.jpg",
+        "skybox/left.jpg",
+        "skybox/top.jpg",
+        "skybox/bottom.jpg",
+        "skybox/front.jpg",
+        "skybox/back.jpg"
+    };
+
+    {
+        // Keep asset loading chatter off stdout so the JSON report stays clean
+        Logger::setOutput(stderr);
+        FrameRenderer frameRenderer(faces);
+        frameRenderer.setSkyboxFirst(options.sky == "first");
+        frameRenderer.setTargetDrawMode(options.draw == "fixed" ? TARGET_DRAW_FIXED :
+            options.draw == "impostor" ? TARGET_DRAW_IMPOSTOR : TARGET_DRAW_LOD);
+        frameRenderer.setTargetShape(options.shape == "uv" ? SPHERE_SHAPE_UV : SPHERE_SHAPE_ICO);
+        Model gunModel("Model/M9.obj");
+
+        std::vector<Light> lights;
+        lights.push_back(Light(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(1.0f, 1.0f, 1.0f), 0.1f, 0.8f, 1.0f));
+        lights.push_back(Light(glm::vec3(3.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.2f, 0.2f), 0.1f, 0.6f, 0.8f));
+        lights.push_back(Light(glm::vec3(-3.0f, 0.0f, 0.0f), glm::vec3(0.2f, 0.2f, 1.0f), 0.1f, 0.6f, 0.8f));
+        lights.push_back(Light(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.2f, 1.0f, 0.2f), 0.1f, 0.6f, 0.8f));
+
+        // Same spawn volume as the game, seeded so runs are comparable
+        std::mt19937 rng(options.seed);
+        std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+        std::uniform_real_distribution<float> colorDist(0.2f, 1.0f);
+        std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+
+        std::vector<Sphere> spheres;
+        spheres.reserve(options.targets);
+        for (int i = 0; i < options.targets; ++i) {
+            glm::vec3 position(posDist(rng), posDist(rng), posDist(rng));
+            float radius = sizeDist(rng);
+            spheres.push_back(Sphere(position, radius, 36, 18));
+            spheres.back().setColor(glm::vec3(colorDist(rng), colorDist(rng), colorDist(rng)));
+        }
+        for (auto& sphere : spheres) {
+            sphere.setup();
+        }
+        Logger::flush();
+
+        unsigned int queries[QUERY_RING];
+        glGenQueries(QUERY_RING, queries);
+
+        std::vector<double> cpuTimes, gpuTimes, frameTimes;
+        size_t issuedCalls = 0, savedCalls = 0;
+        size_t targetsVisible = 0, targetsCulled = 0, targetTriangles = 0;
+        cpuTimes.reserve(options.frames);
+        gpuTimes.reserve(options.frames);
+        frameTimes.reserve(options.frames);
+
+        typedef std::chrono::steady_clock Clock;
+        const int totalFrames = options.warmup + options.frames;
+        const float aspect = (float)options.width / (float)options.height;
+        Clock::time_point previousStart = Clock::now();
+
+        for (int frame = 0; frame < totalFrames + QUERY_RING; ++frame) {
+            int slot = frame % QUERY_RING;
+
+            // Read back the query issued QUERY_RING frames ago
+            int pendingFrame = frame - QUERY_RING;
+            if (pendingFrame >= options.warmup && pendingFrame < totalFrames) {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsed);
+                gpuTimes.push_back(elapsed / 1.0e6);
+            }
+            if (frame >= totalFrames) {
+                continue;
+            }
+
+            Clock::time_point start = Clock::now();
+            if (frame > options.warmup) {
+                frameTimes.push_back(std::chrono::duration<double, std::milli>(start - previousStart).count());
+            }
+            previousStart = start;
+
+            float time = frame / 60.0f;
+            animateLights(lights, time);
+            Camera camera = scriptedCamera(frame, totalFrames);
+
+            // Same setters mouse_button_callback uses on a hit
+            for (int i = 0; i < options.respawns && !spheres.empty(); ++i) {
+                Sphere& sphere = spheres[rng() % spheres.size()];
+                sphere.setPosition(glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+                sphere.setColor(glm::vec3(colorDist(rng), colorDist(rng), colorDist(rng)));
+                sphere.setRadius(sizeDist(rng));
+            }
+
+            glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+            frameRenderer.render(camera, spheres, lights, gunModel, aspect, time);
+            glEndQuery(GL_TIME_ELAPSED);
+            glFlush();
+
+            Clock::time_point end = Clock::now();
+            if (frame >= options.warmup) {
+                cpuTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                issuedCalls += frameRenderer.getStateCache().getIssuedCalls();
+                savedCalls += frameRenderer.getStateCache().getSavedCalls();
+                targetsVisible += frameRenderer.getCullStats().targetsVisible;
+                targetsCulled += frameRenderer.getCullStats().targetsCulled;
+                targetTriangles += frameRenderer.getTargetTriangleCount();
+            }
+        }
+        glFinish();
+        glDeleteQueries(QUERY_RING, queries);
+
+        if (!options.dump.empty() && !dumpFramebuffer(options.dump, options.width, options.height)) {
+            std::cerr << "Cannot write " << options.dump << std::endl;
+        }
+
+        FILE* out = stdout;
+        if (!options.out.empty()) {
+            out = std::fopen(options.out.c_str(), "w");
+            if (!out) {
+                std::cerr << "Cannot write " << options.out << std::endl;
+                return 1;
+            }
+        }
+
+        std::fprintf(out, "{\n");
+        std::fprintf(out, "  \"benchmark\": \"frame\",\n");
+        std::fprintf(out, "  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+        std::fprintf(out, "  \"config\": { \"targets\": %d, \"frames\": %d, \"warmup\": %d, "
+            "\"width\": %d, \"height\": %d, \"respawns\": %d, \"sky\": \"%s\", \"draw\": \"%s\", "
+            "\"shape\": \"%s\", \"seed\": %u },\n",
+            options.targets, options.frames, options.warmup, options.width, options.height,
+            options.respawns, options.sky.c_str(), options.draw.c_str(), options.shape.c_str(), options.seed);
+        std::fprintf(out, "  \"state_calls_per_frame\": { \"issued\": %.1f, \"saved\": %.1f },\n",
+            (double)issuedCalls / options.frames, (double)savedCalls / options.frames);
+        std::fprintf(out, "  \"targets_per_frame\": { \"visible\": %.1f, \"culled\": %.1f, \"triangles\": %.1f },\n",
+            (double)targetsVisible / options.frames, (double)targetsCulled / options.frames,
+            (double)targetTriangles / options.frames);
+        std::fprintf(out, "  \"ms\": {\n");
+        writeStats(out, "cpu_submit", computeStats(cpuTimes), false);
+        writeStats(out, "gpu", computeStats(gpuTimes), false);
+        writeStats(out, "frame", computeStats(frameTimes), true);
+        std::fprintf(out, "  }\n");
+        std::fprintf(out, "}\n");
+        if (out != stdout) {
+            std::fclose(out);
+        }
+    }
+
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteFramebuffers(1, &fbo);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    return 0;
+}
@@ -0,0 +1,1220 @@
+// CPU hot-path microbenchmarks.
+//
+// Covers the load path (sphere generation, OBJ parsing) and the click path
+// (ray-sphere tests over many targets) without needing a GPU: the few GL
+// entry points that are reached are replaced by no-op stubs. Results are
+// written as JSON and compared against a stored baseline; anything slower
+// than the baseline by more than the threshold is flagged as a regression.
+//
+//   MicroBench [--filter TEXT] [--min-time SEC] [--baseline FILE]
+//              [--write-baseline FILE] [--threshold FRACTION] [--out FILE]
+//              [--assets DIR] [--strict]
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "Sphere.h"
+#include "SphereTable.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "Model.h"
+#include "ThreadPool.h"
+#include "Light.h"
+#include "LightBuffer.h"
+#include "CameraBuffer.h"
+#include "TransformSystem.h"
+#include "RenderQueue.h"
+#include "HitTest.h"
+#include "Frustum.h"
+#include "TargetField.h"
+#include "TargetRenderer.h"
+#include "TargetLod.h"
+#include "BenchCommon.h"
+
+#ifndef AIMLAB_ASSET_DIR
+#define AIMLAB_ASSET_DIR "."
+#endif
+
+namespace {
+
+struct Options {
+    std::string filter;
+    double minTime = 0.25;
+    std::string baseline = "Bench/micro_baseline.json";
+    std::string writeBaseline;
+    double threshold = 0.25;
+    std::string out;
+    std::string assets = AIMLAB_ASSET_DIR;
+    bool strict = false;
+};
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp;
+    long long iterations;
+};
+
+// Swallows everything written to it; keeps debug output off the terminal
+// while still paying the formatting cost
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+volatile float floatSink;
+volatile size_t sizeSink;
+
+// Runs every benchmark whose name contains the filter and records ns/op
+class Suite {
+public:
+    Suite(const Options& options) : options(options) {}
+
+    // True when the filter lets a benchmark of this name run, so costly
+    // setup can be skipped for the others
+    bool selected(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    template <typename F>
+    void run(const std::string& name, F&& body) {
+        if (!selected(name)) {
+            return;
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        const int samples = 5;
+
+        // Calibrate the batch size from a single warm-up call
+        Clock::time_point start = Clock::now();
+        body();
+        double once = std::chrono::duration<double>(Clock::now() - start).count();
+        long long batch = std::max(1LL, (long long)(options.minTime / samples / std::max(once, 1e-9)));
+
+        std::vector<double> perOp;
+        long long iterations = 0;
+        for (int s = 0; s < samples; ++s) {
+            start = Clock::now();
+            for (long long i = 0; i < batch; ++i) {
+                body();
+            }
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            perOp.push_back(elapsed / batch);
+            iterations += batch;
+        }
+        std::sort(perOp.begin(), perOp.end());
+
+        results.push_back({ name, perOp[samples / 2], iterations });
+        std::cerr << name << ": " << perOp[samples / 2] << " ns/op" << std::endl;
+    }
+
+    std::vector<BenchResult> results;
+
+private:
+    const Options& options;
+};
+
+// Uniforms the stubbed program reports as active, laid out like the sphere
+// shader (its camera and lights live in uniform blocks)
+std::vector<std::string> stubUniformNames() {
+    return { "shininess" };
+}
+
+const std::vector<std::string>& stubUniforms() {
+    static const std::vector<std::string> names = stubUniformNames();
+    return names;
+}
+
+// GL stubs for code paths that issue uniform updates
+GLint APIENTRY stubGetUniformLocation(GLuint, const GLchar* name) {
+    const std::vector<std::string>& names = stubUniforms();
+    auto it = std::find(names.begin(), names.end(), name);
+    return it != names.end() ? (GLint)(it - names.begin()) : -1;
+}
+void APIENTRY stubGetProgramiv(GLuint, GLenum pname, GLint* params) {
+    if (pname == GL_ACTIVE_UNIFORMS) *params = (GLint)stubUniforms().size();
+    else if (pname == GL_ACTIVE_UNIFORM_MAX_LENGTH) *params = 64;
+    else *params = 0;
+}
+void APIENTRY stubGetActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size,
+    GLenum* type, GLchar* name) {
+    const std::string& uniform = stubUniforms()[index];
+    GLsizei n = std::min((GLsizei)uniform.size(), bufSize - 1);
+    std::memcpy(name, uniform.c_str(), n);
+    name[n] = '\0';
+    *length = n;
+    *size = 1;
+    *type = GL_FLOAT;
+}
+void APIENTRY stubDeleteProgram(GLuint) {}
+void APIENTRY stubUniform3fv(GLint, GLsizei, const GLfloat*) {}
+void APIENTRY stubUniform1f(GLint, GLfloat) {}
+void APIENTRY stubUniform1i(GLint, GLint) {}
+void APIENTRY stubUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+void APIENTRY stubUseProgram(GLuint) {}
+void APIENTRY stubGenObjects(GLsizei n, GLuint* ids) {
+    for (GLsizei i = 0; i < n; ++i) ids[i] = (GLuint)(i + 1);
+}
+void APIENTRY stubDeleteObjects(GLsizei, const GLuint*) {}
+void APIENTRY stubBindVertexArray(GLuint) {}
+void APIENTRY stubBindBuffer(GLenum, GLuint) {}
+void APIENTRY stubBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+void APIENTRY stubBufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) {}
+void APIENTRY stubBindBufferBase(GLenum, GLuint, GLuint) {}
+void APIENTRY stubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+void APIENTRY stubEnableVertexAttribArray(GLuint) {}
+void APIENTRY stubVertexAttribDivisor(GLuint, GLuint) {}
+void APIENTRY stubVertexAttrib4f(GLuint, GLfloat, GLfloat, GLfloat, GLfloat) {}
+void APIENTRY stubVertexAttrib3f(GLuint, GLfloat, GLfloat, GLfloat) {}
+void APIENTRY stubDrawElements(GLenum, GLsizei, GLenum, const void*) {}
+void APIENTRY stubDrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei) {}
+void APIENTRY stubDrawArrays(GLenum, GLint, GLsizei) {}
+void APIENTRY stubCapability(GLenum) {}
+void APIENTRY stubLineWidth(GLfloat) {}
+void APIENTRY stubBindTexture(GLenum, GLuint) {}
+
+void installGLStubs() {
+    glad_glGetUniformLocation = stubGetUniformLocation;
+    glad_glGetProgramiv = stubGetProgramiv;
+    glad_glGetActiveUniform = stubGetActiveUniform;
+    glad_glDeleteProgram = stubDeleteProgram;
+    glad_glUniform3fv = stubUniform3fv;
+    glad_glUniform1f = stubUniform1f;
+    glad_glUniform1i = stubUniform1i;
+    glad_glUniformMatrix4fv = stubUniformMatrix4fv;
+    glad_glUseProgram = stubUseProgram;
+    glad_glGenVertexArrays = stubGenObjects;
+    glad_glGenBuffers = stubGenObjects;
+    glad_glDeleteVertexArrays = stubDeleteObjects;
+    glad_glDeleteBuffers = stubDeleteObjects;
+    glad_glBindVertexArray = stubBindVertexArray;
+    glad_glBindBuffer = stubBindBuffer;
+    glad_glBufferData = stubBufferData;
+    glad_glBufferSubData = stubBufferSubData;
+    glad_glBindBufferBase = stubBindBufferBase;
+    glad_glVertexAttribPointer = stubVertexAttribPointer;
+    glad_glEnableVertexAttribArray = stubEnableVertexAttribArray;
+    glad_glVertexAttribDivisor = stubVertexAttribDivisor;
+    glad_glVertexAttrib4f = stubVertexAttrib4f;
+    glad_glVertexAttrib3f = stubVertexAttrib3f;
+    glad_glDrawElements = stubDrawElements;
+    glad_glDrawElementsInstanced = stubDrawElementsInstanced;
+    glad_glDrawArrays = stubDrawArrays;
+    glad_glEnable = stubCapability;
+    glad_glDisable = stubCapability;
+    glad_glDepthFunc = stubCapability;
+    glad_glActiveTexture = stubCapability;
+    glad_glLineWidth = stubLineWidth;
+    glad_glBindTexture = stubBindTexture;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--strict") {
+            options.strict = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--filter") options.filter = value;
+        else if (arg == "--min-time") options.minTime = std::atof(value);
+        else if (arg == "--baseline") options.baseline = absolutePath(value);
+        else if (arg == "--write-baseline") options.writeBaseline = absolutePath(value);
+        else if (arg == "--threshold") options.threshold = std::atof(value);
+        else if (arg == "--out") options.out = absolutePath(value);
+        else if (arg == "--assets") options.assets = value;
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return options.minTime > 0.0;
+}
+
+std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return baseline;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    std::regex entry("\"name\":\\s*\"([^\"]+)\",\\s*\"ns_per_op\":\\s*([0-9.eE+-]+)");
+    for (std::sregex_iterator it(text.begin(), text.end(), entry), end; it != end; ++it) {
+        baseline[(*it)[1]] = std::atof((*it)[2].str().c_str());
+    }
+    return baseline;
+}
+
+void writeBaselineFile(const std::string& path, const std::vector<BenchResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return;
+    }
+    std::fprintf(file, "{\n  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::fprintf(file, "    { \"name\": \"%s\", \"ns_per_op\": %.2f }%s\n",
+            results[i].name.c_str(), results[i].nsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+
+void benchSphereGeneration(Suite& suite) {
+    const unsigned int resolutions[][2] = { { 12, 12 }, { 36, 18 }, { 64, 32 }, { 128, 64 }, { 256, 128 } };
+    for (const auto& res : resolutions) {
+        Sphere sphere(glm::vec3(1.0f, 2.0f, 3.0f), 0.5f, res[0], res[1]);
+        std::string name = "Sphere::generateVertices/" + std::to_string(res[0]) + "x" + std::to_string(res[1]);
+        suite.run(name, [&]() {
+            sphere.generateVertices();
+        });
+    }
+
+    // Icospheres with the silhouette error of each UV level (see TargetLodRenderer::LEVELS)
+    const unsigned int frequencies[] = { 2, 3, 6, Sphere::DEFAULT_ICO_FREQUENCY, 11 };
+    std::vector<SphereVertex> icoVertices;
+    std::vector<unsigned int> icoIndices;
+    for (unsigned int frequency : frequencies) {
+        suite.run("Sphere::generateIcosphere/" + std::to_string(frequency), [&]() {
+            Sphere::generateIcosphere(frequency, icoVertices, icoIndices);
+        });
+    }
+
+    // Generation plus packing and upload; no other owner keeps the mesh, so
+    // every call builds it again
+    for (const auto& res : resolutions) {
+        std::string name = "Sphere::acquireMesh/" + std::to_string(res[0]) + "x" + std::to_string(res[1]);
+        suite.run(name, [&]() {
+            sizeSink = Sphere::acquireMesh(res[0], res[1])->indexCount;
+        });
+    }
+}
+
+// Writes an OBJ grid of about the given number of triangles, with a
+// position, texture coordinate and normal per grid point, to a temporary
+// file; returns its path, or an empty string if it can't be written
+std::string writeSyntheticObj(size_t triangles) {
+    char path[] = "/tmp/microbench-XXXXXX.obj";
+    int fd = mkstemps(path, 4);
+    if (fd < 0) {
+        return std::string();
+    }
+    FILE* file = fdopen(fd, "w");
+
+    size_t cells = (size_t)std::ceil(std::sqrt(triangles / 2.0));
+    size_t side = cells + 1;
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            std::fprintf(file, "v %.6f %.6f %.6f\n", x * 0.01f, y * 0.01f, std::sin(x * 0.1f) * 0.05f);
+            std::fprintf(file, "vt %.6f %.6f\n", (float)x / cells, (float)y / cells);
+            std::fprintf(file, "vn %.6f %.6f %.6f\n", 0.0f, -0.1f, 0.994987f);
+        }
+    }
+    size_t written = 0;
+    for (size_t y = 0; y < cells && written < triangles; ++y) {
+        for (size_t x = 0; x < cells && written < triangles; ++x, written += 2) {
+            size_t a = y * side + x + 1, b = a + 1, c = a + side, d = c + 1;
+            std::fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, d, d, d);
+            std::fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, d, d, d, c, c, c);
+        }
+    }
+    std::fclose(file);
+    return path;
+}
+
+void benchModelLoad(Suite& suite) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    // Prints parse throughput for the result just added, if it ran
+    auto reportThroughput = [&](const std::string& name, const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!suite.results.empty() && suite.results.back().name == name && file) {
+            double megabytesPerSecond = (double)file.tellg() / suite.results.back().nsPerOp * 1e3;
+            std::cerr << name << ": " << megabytesPerSecond << " MB/s" << std::endl;
+        }
+    };
+
+    suite.run("Model::loadModel/M9.obj", [&]() {
+        Model::parseObj("Model/M9.obj", vertices, indices);
+        sizeSink = vertices.size();
+    });
+    reportThroughput("Model::loadModel/M9.obj", "Model/M9.obj");
+
+    // What a later launch pays instead: mapping and validating the cache
+    std::string cachePath = "/tmp/microbench-M9.obj.meshcache";
+    if (suite.selected("MeshCache::open/M9.obj") && Model::parseObj("Model/M9.obj", vertices, indices) &&
+        MeshCache::write(cachePath, "Model/M9.obj", vertices, indices,
+            std::vector<Submesh>(1, Submesh{ 0, (unsigned int)indices.size(), 0 }), Model::computeBounds(vertices),
+            "M9.mtl", std::vector<std::string>(1, "Material"))) {
+        MeshCache cache;
+        suite.run("MeshCache::open/M9.obj", [&]() {
+            cache.open(cachePath, "Model/M9.obj");
+            sizeSink = cache.getVertexCount();
+        });
+        cache.close();
+        std::remove(cachePath.c_str());
+    }
+
+    for (size_t triangles : { 100000, 2000000 }) {
+        std::string name = "Model::parseObj/synthetic-" + std::to_string(triangles / 1000) + "k";
+        if (!suite.selected(name)) {
+            continue;
+        }
+        std::string path = writeSyntheticObj(triangles);
+        if (path.empty()) {
+            std::cerr << "Cannot write a synthetic OBJ file" << std::endl;
+            continue;
+        }
+        suite.run(name, [&]() {
+            Model::parseObj(path, vertices, indices);
+            sizeSink = vertices.size();
+        });
+        reportThroughput(name, path);
+        std::remove(path.c_str());
+    }
+}
+
+void benchModelMatrix(Suite& suite) {
+    Model model;
+    model.setPosition(glm::vec3(0.3f, -0.2f, 2.5f));
+    model.setScale(glm::vec3(0.08f));
+    float angle = 0.0f;
+    suite.run("Model::getModelMatrix", [&]() {
+        angle += 0.5f;
+        model.setRotation(glm::vec3(angle, -angle, 90.0f));
+        floatSink = model.getModelMatrix()[3][0];
+    });
+}
+
+// Matrices for a field of moving objects: every object recomputed when the
+// camera moves, and only the one that moved when it does not
+void benchTransforms(Suite& suite) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> angleDist(-3.14159f, 3.14159f);
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+
+    for (size_t count : { 1000, 10000 }) {
+        TransformSystem transforms;
+        std::vector<Model> models(count);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 position(posDist(rng), posDist(rng), posDist(rng));
+            glm::vec3 rotation(glm::degrees(angleDist(rng)), glm::degrees(angleDist(rng)), 90.0f);
+            models[i].setPosition(position);
+            models[i].setRotation(rotation);
+            models[i].setScale(glm::vec3(0.08f));
+            transforms.add(position, models[i].getOrientation(), glm::vec3(0.08f));
+        }
+
+        float time = 0.0f;
+        suite.run("Model::getModelMatrix+normal/" + std::to_string(count), [&]() {
+            time += 0.016f;
+            glm::mat4 viewProj = projection * glm::lookAt(glm::vec3(std::sin(time), 0.0f, 3.0f),
+                glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            for (const Model& model : models) {
+                glm::mat4 world = model.getModelMatrix();
+                glm::mat4 mvp = viewProj * world;
+                // Rotation with uniform scale s: the normal matrix is the 3x3 over s^2
+                float scale = model.getScale().x;
+                floatSink = mvp[3][0] + (glm::mat3(world) * (1.0f / (scale * scale)))[0][0];
+            }
+        });
+        suite.run("TransformSystem::update/camera/" + std::to_string(count), [&]() {
+            time += 0.016f;
+            glm::mat4 viewProj = projection * glm::lookAt(glm::vec3(std::sin(time), 0.0f, 3.0f),
+                glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            sizeSink = transforms.update(viewProj);
+        });
+
+        const glm::mat4 viewProj = projection * glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f),
+            glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        size_t next = 0;
+        suite.run("TransformSystem::update+upload/one/" + std::to_string(count), [&]() {
+            transforms.setPosition(next, glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+            next = (next + 1) % count;
+            sizeSink = transforms.update(viewProj);
+            transforms.upload();
+        });
+    }
+}
+
+void benchLightUpdate(Suite& suite) {
+    std::vector<Light> lights;
+    for (int i = 0; i < 8; ++i) {
+        lights.push_back(Light(glm::vec3((float)i, 0.0f, 3.0f)));
+    }
+    LightBuffer lightBuffer;
+
+    // Three lights move every frame as in animateLights, the rest are static
+    float time = 0.0f;
+    suite.run("LightBuffer::update/8", [&]() {
+        time += 0.016f;
+        for (int i = 0; i < 3; ++i) {
+            lights[i].setPosition(glm::vec3(std::sin(time + i), std::cos(time + i), 3.0f));
+        }
+        lightBuffer.update(lights);
+    });
+}
+
+void benchCameraUpdate(Suite& suite) {
+    CameraBuffer cameraBuffer;
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+
+    float time = 0.0f;
+    suite.run("CameraBuffer::update", [&]() {
+        time += 0.016f;
+        glm::vec3 position(std::sin(time), 0.0f, 3.0f);
+        glm::mat4 view = glm::lookAt(position, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        cameraBuffer.update(view, projection, position, time);
+    });
+}
+
+void benchClickPath(Suite& suite) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+
+    const glm::vec3 rayOrigin(0.0f, 0.0f, 3.0f);
+    const glm::vec3 rayDir = glm::normalize(glm::vec3(0.1f, 0.05f, -1.0f));
+
+    for (size_t count : { 1, 10, 100, 1000, 10000, 100000 }) {
+        std::vector<glm::vec3> centers(count);
+        std::vector<float> radii(count);
+        for (size_t i = 0; i < count; ++i) {
+            centers[i] = glm::vec3(posDist(rng), posDist(rng), posDist(rng));
+            radii[i] = sizeDist(rng);
+        }
+
+        // Same per-target work as mouse_button_callback
+        suite.run("raySphereIntersection/" + std::to_string(count), [&]() {
+            float closestDistance = FLT_MAX;
+            for (size_t i = 0; i < count; ++i) {
+                float t;
+                bool hit = raySphereIntersection(rayOrigin, rayDir, centers[i], radii[i] + 1.0f, &t);
+                if (hit && t < closestDistance) {
+                    closestDistance = t;
+                }
+            }
+            floatSink = closestDistance;
+        });
+
+        suite.run("Hitting/" + std::to_string(count), [&]() {
+            for (size_t i = 0; i < count; ++i) {
+                Hitting(rayOrigin, rayDir, centers[i], radii[i] + 1.0f);
+            }
+        });
+
+        TargetField field;
+        field.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            field.add(centers[i], radii[i]);
+        }
+        suite.run("TargetField::closestHit/" + std::to_string(count), [&]() {
+            floatSink = field.closestHit(rayOrigin, rayDir, 1.0f).t;
+        });
+
+        // Same field behind the spawn-volume grid, as the game runs it
+        field.buildIndex(glm::vec3(-5.0f), glm::vec3(5.0f), 1.0f);
+        suite.run("TargetField::closestHit/indexed/" + std::to_string(count), [&]() {
+            floatSink = field.closestHit(rayOrigin, rayDir, 1.0f).t;
+        });
+
+        size_t next = 0;
+        suite.run("TargetField::set/indexed/" + std::to_string(count), [&]() {
+            field.set(next, glm::vec3(posDist(rng), posDist(rng), posDist(rng)), sizeDist(rng));
+            next = (next + 1) % count;
+        });
+    }
+}
+
+// CPU side of submitting the targets: one draw per sphere against the
+// instanced path, with one respawn per frame, and picking detail levels
+// (driver cost is stubbed out)
+void benchTargetSubmit(Suite& suite) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+
+    for (size_t count : { 100, 1000, 10000 }) {
+        std::vector<Sphere> spheres;
+        spheres.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            spheres.push_back(Sphere(glm::vec3(posDist(rng), posDist(rng), posDist(rng)), sizeDist(rng)));
+            spheres.back().setup();
+        }
+
+        ShaderProgram program(1);
+        suite.run("Sphere::render/" + std::to_string(count), [&]() {
+            for (auto& sphere : spheres) {
+                sphere.render(program);
+            }
+        });
+
+        TargetRenderer renderer;
+        size_t next = 0;
+        suite.run("TargetRenderer::update+render/" + std::to_string(count), [&]() {
+            spheres[next].setPosition(glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+            next = (next + 1) % count;
+            renderer.update(spheres);
+            renderer.render();
+        });
+
+        // Level selection with every target visible, camera drifting so
+        // targets cross level thresholds
+        std::vector<unsigned int> visible(count);
+        for (size_t i = 0; i < count; ++i) {
+            visible[i] = (unsigned int)i;
+        }
+        TargetLodRenderer lods;
+        float drift = 0.0f;
+        suite.run("TargetLodRenderer::update/" + std::to_string(count), [&]() {
+            drift = drift > 4.0f ? 0.0f : drift + 0.01f;
+            lods.update(spheres, visible, glm::vec3(0.0f, 0.0f, 3.0f + drift), 2.414f);
+        });
+    }
+}
+
+// Sorting and submitting draws spread over a few programs, vertex arrays and
+// textures in random order; the state cache drops the repeated binds
+void benchRenderQueue(Suite& suite) {
+    std::mt19937 rng(9);
+    RenderQueue queue;
+    GLStateCache state;
+    const size_t count = 1000;
+
+    std::vector<DrawCommand> commands(count);
+    for (DrawCommand& command : commands) {
+        command.program = 1 + rng() % 4;
+        command.vertexArray = 1 + rng() % 8;
+        command.texture = 1 + rng() % 4;
+        command.count = 36;
+        command.key = RenderQueue::makeKey(PASS_OPAQUE, command.program, command.vertexArray,
+            command.texture, (rng() % 1000) / 1000.0f);
+    }
+
+    suite.run("RenderQueue::submit+execute/" + std::to_string(count), [&]() {
+        queue.clear();
+        for (const DrawCommand& command : commands) {
+            queue.submit(command);
+        }
+        state.invalidate();
+        state.resetCounters();
+        queue.execute(state);
+        sizeSink = state.getSavedCalls();
+    });
+    std::cerr << "RenderQueue: " << count << " draws, state calls issued " << state.getIssuedCalls()
+        << ", saved " << state.getSavedCalls() << std::endl;
+}
+
+// Checks the SIMD closest-hit kernel against the scalar reference over
+// random rays; returns the number of mismatches
+int verifyHitKernel() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+
+    int mismatches = 0;
+    for (size_t count : { 1, 3, 8, 13, 100, 1027 }) {
+        std::vector<float> x(count), y(count), z(count), r(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = posDist(rng);
+            y[i] = posDist(rng);
+            z[i] = posDist(rng);
+            r[i] = sizeDist(rng);
+        }
+        for (int ray = 0; ray < 200; ++ray) {
+            glm::vec3 origin(posDist(rng), posDist(rng), posDist(rng));
+            glm::vec3 dir = glm::normalize(glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+            RayHit fast = closestRaySphereHit(x.data(), y.data(), z.data(), r.data(), count, origin, dir, 1.0f);
+            RayHit reference = closestRaySphereHitScalar(x.data(), y.data(), z.data(), r.data(), count, origin, dir, 1.0f);
+            if (fast.index != reference.index || (fast.index >= 0 && fast.t != reference.t)) {
+                ++mismatches;
+            }
+        }
+    }
+    std::cerr << "closestRaySphereHit kernel: " << closestRaySphereHitKernel()
+        << ", mismatches vs scalar: " << mismatches << std::endl;
+    return mismatches;
+}
+
+// Checks the batched transform kernel against the scalar path and against
+// glm composition of the same transforms; returns the number of mismatches
+int verifyTransforms() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> angleDist(-3.14159f, 3.14159f);
+    std::uniform_real_distribution<float> scaleDist(0.05f, 2.0f);
+
+    auto close = [](const float* a, const float* b, int n) {
+        for (int k = 0; k < n; ++k) {
+            if (std::fabs(a[k] - b[k]) > 1e-4f * std::max(1.0f, std::fabs(b[k]))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const glm::mat4 viewProj = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 1.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    int mismatches = 0;
+    for (size_t count : { 1, 3, 4, 13, 100 }) {
+        TransformSystem fast, reference;
+        std::vector<glm::mat4> expected;
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 position(posDist(rng), posDist(rng), posDist(rng));
+            glm::quat rotation = glm::angleAxis(angleDist(rng),
+                glm::normalize(glm::vec3(posDist(rng), posDist(rng), posDist(rng)) + glm::vec3(0.01f)));
+            glm::vec3 scale = (i % 2) ? glm::vec3(scaleDist(rng)) : glm::vec3(scaleDist(rng), scaleDist(rng), scaleDist(rng));
+            fast.add(position, rotation, scale);
+            reference.add(position, rotation, scale);
+            expected.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation), scale));
+        }
+        fast.update(viewProj);
+        reference.updateScalar(viewProj);
+
+        // Move one object and recompute only what is dirty
+        glm::vec3 moved(1.0f, 2.0f, 3.0f);
+        size_t last = count - 1;
+        fast.setPosition(last, moved);
+        reference.setPosition(last, moved);
+        expected[last][3] = glm::vec4(moved, 1.0f);
+        fast.update(viewProj);
+        reference.updateScalar(viewProj);
+
+        for (size_t i = 0; i < count; ++i) {
+            const TransformInstance& a = fast.get(i);
+            const TransformInstance& b = reference.get(i);
+            glm::mat4 mvp = viewProj * expected[i];
+            glm::mat3 normal = glm::inverseTranspose(glm::mat3(expected[i]));
+            glm::mat3 fastNormal(glm::vec3(a.normal[0]), glm::vec3(a.normal[1]), glm::vec3(a.normal[2]));
+            if (std::memcmp(&a, &b, sizeof(TransformInstance)) != 0 ||
+                !close(&a.world[0][0], &expected[i][0][0], 16) ||
+                !close(&a.mvp[0][0], &mvp[0][0], 16) ||
+                !close(&fastNormal[0][0], &normal[0][0], 9)) {
+                ++mismatches;
+            }
+        }
+    }
+    std::cerr << "TransformSystem kernel: " << TransformSystem::kernel()
+        << ", mismatches vs scalar and glm: " << mismatches << std::endl;
+    return mismatches;
+}
+
+// Checks the SIMD culling kernel against the scalar path and the
+// per-sphere test, over camera directions that cull nothing to almost
+// everything; returns the number of mismatching lists
+int verifyCulling() {
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> posDist(-12.0f, 12.0f);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+
+    int mismatches = 0;
+    for (size_t count : { 1, 3, 4, 13, 1000 }) {
+        std::vector<float> x(count), y(count), z(count), r(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = posDist(rng);
+            y[i] = posDist(rng);
+            z[i] = posDist(rng);
+            r[i] = sizeDist(rng);
+        }
+
+        for (int view = 0; view < 16; ++view) {
+            glm::vec3 eye(posDist(rng), posDist(rng), posDist(rng));
+            glm::vec3 target(posDist(rng), posDist(rng), posDist(rng));
+            Frustum frustum = Frustum::fromMatrix(projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+            std::vector<unsigned int> fast, reference, expected;
+            cullSpheres(frustum, x.data(), y.data(), z.data(), r.data(), count, fast);
+            cullSpheresScalar(frustum, x.data(), y.data(), z.data(), r.data(), count, reference);
+            for (size_t i = 0; i < count; ++i) {
+                if (frustum.intersects(BoundingSphere{ glm::vec3(x[i], y[i], z[i]), r[i] })) {
+                    expected.push_back((unsigned int)i);
+                }
+            }
+            if (fast != reference || fast != expected) {
+                ++mismatches;
+            }
+        }
+    }
+    std::cerr << "Culling kernel: " << cullSpheresKernel() << ", mismatches vs scalar: " << mismatches << std::endl;
+    return mismatches;
+}
+
+// Prints triangles, silhouette error and FIFO cache misses of each UV
+// detail level next to the icosphere that replaces it
+void reportSphereMeshes() {
+    const unsigned int levels[][3] = { { 8, 4, 2 }, { 16, 8, 3 }, { 32, 16, 6 },
+        { 36, 18, Sphere::DEFAULT_ICO_FREQUENCY }, { 64, 32, 11 } };
+    for (const auto& level : levels) {
+        Sphere uv(glm::vec3(0.0f), 1.0f, level[0], level[1]);
+        uv.generateVertices();
+        std::vector<SphereVertex> icoVertices;
+        std::vector<unsigned int> icoIndices;
+        Sphere::generateIcosphere(level[2], icoVertices, icoIndices);
+
+        std::fprintf(stderr, "Sphere %ux%u: %zu triangles, error %.4f, ACMR %.2f | icosphere %u: %zu triangles, "
+            "error %.4f, ACMR %.2f\n", level[0], level[1], uv.getIndices().size() / 3,
+            Sphere::meshError(uv.getVertices(), uv.getIndices()), averageCacheMissRatio(uv.getIndices(), 16),
+            level[2], icoIndices.size() / 3, Sphere::meshError(icoVertices, icoIndices),
+            averageCacheMissRatio(icoIndices, 16));
+    }
+}
+
+// Prints how far welding shrinks the gun's vertex buffer and how the cache
+// ordering Model::loadModel applies changes vertex cache misses, then how
+// the gun splits by material
+void reportModelMesh() {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    ObjMaterials objMaterials;
+    if (!Model::parseObj("Model/M9.obj", vertices, indices, &objMaterials)) {
+        return;
+    }
+    std::vector<Material> materials;
+    Model::parseMtl("Model/" + objMaterials.library, materials);
+    size_t corners = 0;
+    std::ifstream file("Model/M9.obj");
+    for (std::string line; std::getline(file, line);) {
+        if (line.compare(0, 2, "f ") == 0) {
+            std::istringstream tokens(line.substr(2));
+            for (std::string token; tokens >> token;) {
+                ++corners;
+            }
+        }
+    }
+
+    float before = averageCacheMissRatio(indices, 16);
+    optimizeVertexCache(indices, vertices.size());
+    std::fprintf(stderr, "M9.obj: %zu triangles, %zu vertices for %zu face corners (%.1f%% fewer, %zu KB), "
+        "ACMR %.2f -> %.2f\n", indices.size() / 3, vertices.size(), corners,
+        100.0 * (1.0 - (double)vertices.size() / corners), vertices.size() * sizeof(Vertex) / 1024, before,
+        averageCacheMissRatio(indices, 16));
+    std::fprintf(stderr, "M9.obj: %zu submeshes, %zu materials in %s\n", objMaterials.submeshes.size(),
+        materials.size(), objMaterials.library.c_str());
+}
+
+// Compares a compile-time sphere table with generateVertices at the same
+// detail level; returns the number of differing vertices and indices
+template <unsigned int Sectors, unsigned int Stacks>
+int compareSphereTable() {
+    const SphereTable<Sectors, Stacks>& table = sphereTable<Sectors, Stacks>();
+    Sphere sphere(glm::vec3(0.0f), 1.0f, Sectors, Stacks);
+    sphere.generateVertices();
+    const std::vector<SphereVertex>& vertices = sphere.getVertices();
+    const std::vector<unsigned int>& indices = sphere.getIndices();
+
+    int mismatches = 0;
+    if (vertices.size() != table.VERTEX_COUNT || indices.size() != table.INDEX_COUNT) {
+        return 1;
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const SphereVertex& a = vertices[i];
+        const SphereVertex& b = table.vertices[i];
+        if (a.x != b.x || a.y != b.y || a.z != b.z || a.w != b.w) {
+            ++mismatches;
+        }
+    }
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] != table.indices[i]) {
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+int verifySphereTables() {
+    int mismatches = compareSphereTable<36, 18>() + compareSphereTable<12, 12>();
+    std::cerr << "Sphere tables mismatches vs generateVertices: " << mismatches << std::endl;
+    return mismatches;
+}
+
+// Writes a mesh cache for a copy of M9.obj and checks it maps back to the
+// parsed data, survives a touch (taking the new timestamp), and is rejected
+// once the source changes or a submesh names a material it doesn't store
+int verifyMeshCache() {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    ObjMaterials materials;
+    std::ifstream in("Model/M9.obj", std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (text.empty() || !Model::parseObjData(text.data(), text.size(), vertices, indices, 0, &materials)) {
+        return 0;
+    }
+
+    char sourcePath[] = "/tmp/microbench-XXXXXX.obj";
+    int fd = mkstemps(sourcePath, 4);
+    if (fd < 0) {
+        return 0;
+    }
+    close(fd);
+    auto writeSource = [&](const std::string& contents) {
+        std::ofstream(sourcePath, std::ios::binary | std::ios::trunc) << contents;
+    };
+    writeSource(text);
+
+    std::string cachePath = MeshCache::pathFor(sourcePath);
+    BoundingSphere bounds = Model::computeBounds(vertices);
+    int mismatches = 0;
+    MeshCache cache;
+    if (!MeshCache::write(cachePath, sourcePath, vertices, indices, materials.submeshes, bounds,
+            materials.library, materials.names) ||
+        !cache.open(cachePath, sourcePath) || cache.getVertexCount() != vertices.size() ||
+        cache.getIndexCount() != indices.size() || cache.getSubmeshCount() != materials.submeshes.size() ||
+        std::memcmp(cache.getSubmeshes(), materials.submeshes.data(),
+            materials.submeshes.size() * sizeof(Submesh)) != 0 ||
+        cache.getMaterialLibrary() != materials.library || cache.getMaterialNames() != materials.names ||
+        std::memcmp(cache.getVertices(), vertices.data(), vertices.size() * sizeof(Vertex)) != 0 ||
+        std::memcmp(cache.getIndices(), indices.data(), indices.size() * sizeof(unsigned int)) != 0 ||
+        cache.getBounds().radius != bounds.radius) {
+        ++mismatches;
+    }
+    cache.close();
+
+    // Same bytes written again: new timestamp, same hash, and the cache
+    // stamped with the new time so the next open skips the hash
+    writeSource(text);
+    mismatches += cache.open(cachePath, sourcePath) ? 0 : 1;
+    cache.close();
+    MeshCacheHeader header = {};
+    struct stat info;
+    std::ifstream(cachePath, std::ios::binary).read((char*)&header, sizeof(header));
+    if (stat(sourcePath, &info) != 0 ||
+        header.sourceTime != (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec) {
+        ++mismatches;
+    }
+
+    // One digit changed, same size
+    std::string edited = text;
+    edited[edited.find("v ") + 2] = edited[edited.find("v ") + 2] == '1' ? '2' : '1';
+    writeSource(edited);
+    mismatches += cache.open(cachePath, sourcePath) ? 1 : 0;
+    cache.close();
+
+    // A line appended
+    writeSource(text + "# edited\n");
+    mismatches += cache.open(cachePath, sourcePath) ? 1 : 0;
+    cache.close();
+
+    // A submesh naming a material past the stored names
+    std::vector<Submesh> badSubmeshes = materials.submeshes;
+    badSubmeshes.back().material = (unsigned int)materials.names.size();
+    writeSource(text);
+    MeshCache::write(cachePath, sourcePath, vertices, indices, badSubmeshes, bounds, materials.library,
+        materials.names);
+    mismatches += cache.open(cachePath, sourcePath) ? 1 : 0;
+    cache.close();
+
+    std::remove(sourcePath);
+    std::remove(cachePath.c_str());
+    std::cerr << "Mesh cache mismatches vs parseObj: " << mismatches << std::endl;
+    return mismatches;
+}
+
+// Rewrites the face indices of OBJ text as negative ones relative to the
+// records read so far, which must name the same vertices
+std::string relativeObjIndices(const std::string& text) {
+    std::istringstream lines(text);
+    std::ostringstream out;
+    long counts[3] = {}; // v, vt, vn
+    for (std::string line; std::getline(lines, line);) {
+        if (line.compare(0, 2, "v ") == 0) {
+            ++counts[0];
+        }
+        else if (line.compare(0, 3, "vt ") == 0) {
+            ++counts[1];
+        }
+        else if (line.compare(0, 3, "vn ") == 0) {
+            ++counts[2];
+        }
+        else if (line.compare(0, 2, "f ") == 0) {
+            std::istringstream tokens(line.substr(2));
+            line = "f";
+            for (std::string token; tokens >> token;) {
+                line += ' ';
+                size_t start = 0;
+                for (int part = 0; part < 3 && start <= token.size(); ++part) {
+                    size_t slash = std::min(token.find('/', start), token.size());
+                    std::string number = token.substr(start, slash - start);
+                    line += number.empty() ? "" : std::to_string(std::stol(number) - counts[part] - 1);
+                    line += slash < token.size() ? "/" : "";
+                    start = slash + 1;
+                }
+            }
+        }
+        out << line << '\n';
+    }
+    return out.str();
+}
+
+// Parses M9.obj in one piece and in line-aligned chunks, with its face
+// indices absolute and relative; returns how many results (material split
+// included) differ from the single-chunk absolute parse
+int verifyObjChunks() {
+    std::ifstream in("Model/M9.obj", std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string relative = relativeObjIndices(text);
+
+    std::vector<Vertex> expectedVertices, vertices;
+    std::vector<unsigned int> expectedIndices, indices;
+    ObjMaterials expectedMaterials, materials;
+    Model::parseObjData(text.data(), text.size(), expectedVertices, expectedIndices, 1, &expectedMaterials);
+    int mismatches = expectedIndices.empty() ? 1 : 0;
+    for (const std::string* source : { &text, &relative }) {
+        for (unsigned int chunks : { 1u, 2u, 7u, 64u }) {
+            Model::parseObjData(source->data(), source->size(), vertices, indices, chunks, &materials);
+            if (indices != expectedIndices || vertices.size() != expectedVertices.size() ||
+                std::memcmp(vertices.data(), expectedVertices.data(), vertices.size() * sizeof(Vertex)) != 0 ||
+                materials.library != expectedMaterials.library || materials.names != expectedMaterials.names ||
+                materials.submeshes.size() != expectedMaterials.submeshes.size() ||
+                std::memcmp(materials.submeshes.data(), expectedMaterials.submeshes.data(),
+                    materials.submeshes.size() * sizeof(Submesh)) != 0) {
+                ++mismatches;
+            }
+        }
+    }
+    std::cerr << "OBJ chunked and relative-index parse mismatches: " << mismatches << " ("
+        << ThreadPool::shared().getThreadCount() << " threads)" << std::endl;
+    return mismatches;
+}
+
+// Checks grid queries against the linear scan, including respawns and
+// targets outside the grid; returns the number of mismatches
+int verifyTargetIndex() {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> posDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> wideDist(-8.0f, 8.0f);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+
+    int mismatches = 0;
+    for (size_t count : { 256, 1000, 5000 }) {
+        TargetField field;
+        std::vector<float> x(count), y(count), z(count), r(count);
+        for (size_t i = 0; i < count; ++i) {
+            field.add(glm::vec3(posDist(rng), posDist(rng), posDist(rng)), sizeDist(rng));
+        }
+        field.buildIndex(glm::vec3(-5.0f), glm::vec3(5.0f), 1.0f);
+
+        for (int ray = 0; ray < 300; ++ray) {
+            size_t moved = rng() % count;
+            field.set(moved, glm::vec3(wideDist(rng), wideDist(rng), wideDist(rng)), sizeDist(rng));
+            for (size_t i = 0; i < count; ++i) {
+                glm::vec3 c = field.getCenter(i);
+                x[i] = c.x;
+                y[i] = c.y;
+                z[i] = c.z;
+                r[i] = field.getRadius(i);
+            }
+
+            glm::vec3 origin(wideDist(rng), wideDist(rng), wideDist(rng));
+            glm::vec3 dir = glm::normalize(glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+            float tolerance = (ray % 2) ? 1.0f : 0.0f;
+            // closestHit renormalizes, which can move the last bit of dir
+            RayHit indexed = field.closestHit(origin, dir, tolerance);
+            RayHit reference = closestRaySphereHitScalar(x.data(), y.data(), z.data(), r.data(), count, origin,
+                glm::normalize(dir), tolerance);
+            if (indexed.index != reference.index || (indexed.index >= 0 && indexed.t != reference.t)) {
+                ++mismatches;
+            }
+        }
+    }
+    std::cerr << "TargetField index mismatches vs linear scan: " << mismatches << std::endl;
+    return mismatches;
+}
+
+// 100k-target stress field whose spawn volume grows with the count so the
+// target density stays that of the game's 10x10x10 volume with 100 targets
+void benchStressField(Suite& suite) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+    const glm::vec3 rayOrigin(0.0f, 0.0f, 3.0f);
+
+    for (size_t count : { 100, 1000, 10000, 100000 }) {
+        float extent = 5.0f * std::cbrt(count / 100.0f);
+        std::uniform_real_distribution<float> posDist(-extent, extent);
+
+        TargetField field;
+        field.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            field.add(glm::vec3(posDist(rng), posDist(rng), posDist(rng)), sizeDist(rng));
+        }
+
+        std::vector<glm::vec3> dirs(64);
+        for (auto& dir : dirs) {
+            dir = glm::normalize(glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+        }
+
+        size_t ray = 0;
+        suite.run("TargetField::closestHit/stress/" + std::to_string(count), [&]() {
+            floatSink = field.closestHit(rayOrigin, dirs[ray++ & 63], 1.0f).t;
+        });
+
+        field.buildIndex(glm::vec3(-extent), glm::vec3(extent), 1.0f);
+        suite.run("TargetField::closestHit/stress/indexed/" + std::to_string(count), [&]() {
+            floatSink = field.closestHit(rayOrigin, dirs[ray++ & 63], 1.0f).t;
+        });
+    }
+}
+
+// Frustum culling pass over the stress field seen from the spawn point,
+// where roughly a tenth of the targets are in view
+void benchCulling(Suite& suite) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> sizeDist(0.3f, 0.8f);
+    const Frustum frustum = Frustum::fromMatrix(glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+    for (size_t count : { 100, 1000, 10000, 100000 }) {
+        float extent = 5.0f * std::cbrt(count / 100.0f);
+        std::uniform_real_distribution<float> posDist(-extent, extent);
+        std::vector<float> x(count), y(count), z(count), r(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = posDist(rng);
+            y[i] = posDist(rng);
+            z[i] = posDist(rng);
+            r[i] = sizeDist(rng);
+        }
+
+        std::vector<unsigned int> visible;
+        visible.reserve(count);
+        suite.run("cullSpheres/" + std::to_string(count), [&]() {
+            visible.clear();
+            sizeSink = cullSpheres(frustum, x.data(), y.data(), z.data(), r.data(), count, visible);
+        });
+        suite.run("cullSpheresScalar/" + std::to_string(count), [&]() {
+            visible.clear();
+            sizeSink = cullSpheresScalar(frustum, x.data(), y.data(), z.data(), r.data(), count, visible);
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: MicroBench [--filter TEXT] [--min-time SEC] [--baseline FILE] "
+            "[--write-baseline FILE] [--threshold FRACTION] [--out FILE] [--assets DIR] [--strict]" << std::endl;
+        return 2;
+    }
+    if (chdir(options.assets.c_str()) != 0) {
+        std::cerr << "Cannot enter asset directory " << options.assets << std::endl;
+        return 1;
+    }
+
+    installGLStubs();
+
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    int kernelMismatches = verifyHitKernel() + verifyTargetIndex() + verifyTransforms() +
+        verifyCulling() + verifySphereTables() + verifyMeshCache() + verifyObjChunks();
+    reportSphereMeshes();
+    reportModelMesh();
+
+    Suite suite(options);
+    benchSphereGeneration(suite);
+    benchModelLoad(suite);
+    benchModelMatrix(suite);
+    benchTransforms(suite);
+    benchLightUpdate(suite);
+    benchCameraUpdate(suite);
+    benchClickPath(suite);
+    benchStressField(suite);
+    benchCulling(suite);
+    benchTargetSubmit(suite);
+    benchRenderQueue(suite);
+
+    std::cout.rdbuf(coutBuffer);
+
+    if (!options.writeBaseline.empty()) {
+        writeBaselineFile(options.writeBaseline, suite.results);
+    }
+
+    std::map<std::string, double> baseline = loadBaseline(options.baseline);
+
+    FILE* out = stdout;
+    if (!options.out.empty()) {
+        out = std::fopen(options.out.c_str(), "w");
+        if (!out) {
+            std::cerr << "Cannot write " << options.out << std::endl;
+            return 1;
+        }
+    }
+
+    int regressions = 0;
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"micro\",\n");
+    std::fprintf(out, "  \"threshold\": %.3f,\n", options.threshold);
+    std::fprintf(out, "  \"hit_kernel\": \"%s\",\n", closestRaySphereHitKernel());
+    std::fprintf(out, "  \"hit_kernel_mismatches\": %d,\n", kernelMismatches);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < suite.results.size(); ++i) {
+        const BenchResult& r = suite.results[i];
+        std::fprintf(out, "    { \"name\": \"%s\", \"ns_per_op\": %.2f, \"iterations\": %lld",
+            r.name.c_str(), r.nsPerOp, r.iterations);
+
+        auto base = baseline.find(r.name);
+        if (base != baseline.end() && base->second > 0.0) {
+            double ratio = r.nsPerOp / base->second;
+            const char* status = "ok";
+            if (ratio > 1.0 + options.threshold) {
+                status = "regression";
+                ++regressions;
+            }
+            else if (ratio < 1.0 - options.threshold) {
+                status = "improved";
+            }
+            std::fprintf(out, ", \"baseline_ns_per_op\": %.2f, \"ratio\": %.3f, \"status\": \"%s\"",
+                base->second, ratio, status);
+        }
+        else {
+            std::fprintf(out, ", \"status\": \"new\"");
+        }
+        std::fprintf(out, " }%s\n", i + 1 < suite.results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+    std::fprintf(out, "  \"regressions\": %d\n", regressions);
+    std::fprintf(out, "}\n");
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    if (kernelMismatches > 0) {
+        return 1;
+    }
+    return (options.strict && regressions > 0) ? 1 : 0;
+}
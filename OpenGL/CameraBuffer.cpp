@@ -0,0 +1,20 @@
+#include "CameraBuffer.h"
+
+CameraBuffer::CameraBuffer() : buffer(sizeof(CameraBlock), CAMERA_BUFFER_BINDING) {
+}
+
+void CameraBuffer::update(const glm::mat4& view, const glm::mat4& projection,
+    const glm::vec3& cameraPos, float time) {
+    CameraBlock block;
+    block.view = view;
+    block.projection = projection;
+    block.viewProj = projection * view;
+    block.cameraPos = cameraPos;
+    block.time = time;
+
+    buffer.upload(&block);
+}
+
+size_t CameraBuffer::getUploadCount() const {
+    return buffer.getUploadCount();
+}
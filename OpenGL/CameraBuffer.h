@@ -0,0 +1,46 @@
+#ifndef CAMERA_BUFFER_H
+#define CAMERA_BUFFER_H
+
+#include <glm/glm.hpp>
+#include "UniformBuffer.h"
+
+// Per-frame camera state is shared by every program through one uniform buffer
+#define CAMERA_BUFFER_BINDING 1
+
+// GLSL declaration of the block, spliced into the shader sources
+#define CAMERA_BLOCK_GLSL \
+    "layout (std140) uniform Camera {\n" \
+    "    mat4 view;\n" \
+    "    mat4 projection;\n" \
+    "    mat4 viewProj;\n" \
+    "    vec3 cameraPos;\n" \
+    "    float time;\n" \
+    "};\n"
+
+// CPU mirror of the block
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProj;
+    glm::vec3 cameraPos;
+    float time;
+};
+
+static_assert(sizeof(CameraBlock) == 208, "CameraBlock must match the std140 Camera block");
+
+// Writes the "Camera" block at CAMERA_BUFFER_BINDING once per frame
+class CameraBuffer {
+public:
+    CameraBuffer();
+
+    // Fills in viewProj and uploads the block with one call
+    void update(const glm::mat4& view, const glm::mat4& projection,
+        const glm::vec3& cameraPos, float time);
+
+    size_t getUploadCount() const;
+
+private:
+    UniformBuffer buffer;
+};
+
+#endif // CAMERA_BUFFER_H
@@ -0,0 +1,21 @@
+#ifndef CROSSHAIR_SHADER_H
+#define CROSSHAIR_SHADER_H
+
+// Crosshair shader sources
+const char* crosshairVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+void main() {
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
+)";
+
+const char* crosshairFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(1.0, 1.0, 1.0, 0.8);
+}
+)";
+
+#endif // CROSSHAIR_SHADER_H
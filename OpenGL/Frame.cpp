@@ -0,0 +1,418 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "Frame.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include "SphereShader.h"
+#include "ModelShader.h"
+#include "SkyboxShader.h"
+#include "CrosshairShader.h"
+#include "Log.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// Skybox vertices - Using larger size to ensure visibility
+static const float skyboxVertices[] = {
+    // positions
+    -10.0f,  10.0f, -10.0f,
+    -10.0f, -10.0f, -10.0f,
+     10.0f, -10.0f, -10.0f,
+     10.0f,  10.0f, -10.0f,
+    -10.0f, -10.0f,  10.0f,
+    -10.0f,  10.0f,  10.0f,
+     10.0f, -10.0f,  10.0f,
+     10.0f,  10.0f,  10.0f
+};
+
+// Skybox indices
+static const unsigned int skyboxIndices[] = {
+    // Back face
+    0, 1, 3, 3, 1, 2,
+    // Left face
+    5, 1, 0, 5, 4, 1,
+    // Front face
+    7, 6, 4, 7, 4, 5,
+    // Right face
+    3, 2, 7, 7, 2, 6,
+    // Top face
+    5, 0, 7, 7, 0, 3,
+    // Bottom face
+    1, 4, 2, 2, 4, 6
+};
+
+// Crosshair vertices (simple cross)
+static const float crosshairVertices[] = {
+    // Horizontal line
+    -0.02f,  0.0f,
+     0.02f,  0.0f,
+     // Vertical line
+      0.0f, -0.03f,
+      0.0f,  0.03f
+};
+
+ModelUniforms::ModelUniforms(const ShaderProgram& program) {
+    materialIndex = program.getUniform("materialIndex");
+    hasTexture = program.getUniform("hasTexture");
+}
+
+FrameRenderer::FrameRenderer(const std::vector<std::string>& skyboxFaces)
+    : skyboxShader(compileSpecialShader(skyboxVertexShaderSource, skyboxFragmentShaderSource, "Skybox")),
+    sphereShader(compileSpecialShader(sphereVertexShaderSource, sphereFragmentShaderSource, "Sphere")),
+    sphereImpostorShader(compileSpecialShader(sphereImpostorVertexShaderSource, sphereImpostorFragmentShaderSource,
+        "Sphere impostor")),
+    modelShader(compileSpecialShader(modelVertexShaderSource, modelFragmentShaderSource, "Model")),
+    crosshairShader(compileSpecialShader(crosshairVertexShaderSource, crosshairFragmentShaderSource, "Crosshair")),
+    modelUniforms(modelShader),
+    skyboxFirst(false),
+    targetDrawMode(TARGET_DRAW_LOD),
+    targetShape(SPHERE_SHAPE_ICO),
+    targetIcoRenderer(Sphere::acquireIcoMesh(Sphere::DEFAULT_ICO_FREQUENCY)),
+    targetIcoLods(SPHERE_SHAPE_ICO),
+    targetImpostors(Sphere::acquireImpostorQuad()),
+    cullStats() {
+
+    gunTransform = transforms.add();
+
+    sphereShininess = sphereShader.getUniform("shininess");
+    sphereImpostorShininess = sphereImpostorShader.getUniform("shininess");
+
+    // Setup crosshair VAO
+    glGenVertexArrays(1, &crosshairVAO);
+    glGenBuffers(1, &crosshairVBO);
+
+    glBindVertexArray(crosshairVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, crosshairVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(crosshairVertices), crosshairVertices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Setup skybox VAO
+    glGenVertexArrays(1, &skyboxVAO);
+    glGenBuffers(1, &skyboxVBO);
+    glGenBuffers(1, &skyboxEBO);
+
+    glBindVertexArray(skyboxVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, skyboxEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(skyboxIndices), skyboxIndices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    cubemapTexture = loadCubemap(skyboxFaces);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+FrameRenderer::~FrameRenderer() {
+    glDeleteVertexArrays(1, &skyboxVAO);
+    glDeleteVertexArrays(1, &crosshairVAO);
+    glDeleteBuffers(1, &skyboxVBO);
+    glDeleteBuffers(1, &skyboxEBO);
+    glDeleteBuffers(1, &crosshairVBO);
+    glDeleteTextures(1, &cubemapTexture);
+}
+
+void FrameRenderer::render(const Camera& camera, std::vector<Sphere>& spheres,
+    std::vector<Light>& lights, Model& gunModel, float aspect, float time) {
+
+    // Clear buffers
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Create view and projection matrices
+    glm::mat4 view = glm::lookAt(camera.position, camera.position + camera.front, camera.up);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+    glm::mat4 viewProj = projection * view;
+
+    // Upload camera and lights once for every program that reads them
+    cameraBuffer.update(view, projection, camera.position, time);
+    lightBuffer.update(lights);
+    materialBuffer.update(gunModel.getMaterials());
+
+    // Rebuild the matrices of objects that moved (or all of them when the camera did)
+    placeGunModel(gunModel, camera);
+    transforms.setPosition(gunTransform, gunModel.getPosition());
+    transforms.setRotation(gunTransform, gunModel.getOrientation());
+    transforms.setScale(gunTransform, gunModel.getScale());
+    transforms.update(viewProj);
+    transforms.upload();
+    for (const Mesh& mesh : gunModel.getMeshes()) {
+        if (std::find(gunVertexArrays.begin(), gunVertexArrays.end(), mesh.VAO) == gunVertexArrays.end()) {
+            transforms.bindAttributes(mesh.VAO, gunTransform);
+            gunVertexArrays.push_back(mesh.VAO);
+        }
+    }
+
+    // Drop targets and models entirely outside the view before anything is queued
+    Frustum frustum = Frustum::fromMatrix(viewProj);
+    size_t targetCount = spheres.size();
+    boundsX.resize(targetCount);
+    boundsY.resize(targetCount);
+    boundsZ.resize(targetCount);
+    boundsRadius.resize(targetCount);
+    for (size_t i = 0; i < targetCount; ++i) {
+        BoundingSphere bounds = spheres[i].getBounds();
+        boundsX[i] = bounds.center.x;
+        boundsY[i] = bounds.center.y;
+        boundsZ[i] = bounds.center.z;
+        boundsRadius[i] = bounds.radius;
+    }
+    visibleTargets.clear();
+    cullStats.targetsVisible = cullSpheres(frustum, boundsX.data(), boundsY.data(), boundsZ.data(),
+        boundsRadius.data(), targetCount, visibleTargets);
+    cullStats.targetsCulled = targetCount - cullStats.targetsVisible;
+
+    bool gunVisible = frustum.intersects(transformBounds(gunModel.getBounds(), transforms.get(gunTransform).world));
+    cullStats.modelsVisible = gunVisible ? 1 : 0;
+    cullStats.modelsCulled = gunVisible ? 0 : 1;
+
+    // Instance data for the meshes of the current draw mode and shape
+    TargetRenderer& fixed = targetShape == SPHERE_SHAPE_ICO ? targetIcoRenderer : targetRenderer;
+    TargetLodRenderer& lods = targetShape == SPHERE_SHAPE_ICO ? targetIcoLods : targetLods;
+    switch (targetDrawMode) {
+    case TARGET_DRAW_LOD:
+        lods.update(spheres, visibleTargets, camera.position, projection[1][1]);
+        break;
+    case TARGET_DRAW_IMPOSTOR:
+        targetImpostors.update(spheres, visibleTargets);
+        break;
+    default:
+        fixed.update(spheres, visibleTargets);
+        break;
+    }
+
+    // Queue every draw with its state; the queue sorts by pass, program,
+    // vertex array and material and skips redundant state changes
+    queue.clear();
+
+    // Skybox at the far plane (the shader writes depth 1.0), after the opaque
+    // pass unless skyboxFirst is set; GL_LEQUAL keeps it visible where the
+    // depth buffer still holds the cleared value
+    DrawCommand skybox;
+    skybox.key = RenderQueue::makeKey(skyboxFirst ? PASS_BACKGROUND : PASS_SKY,
+        skyboxShader.getId(), skyboxVAO, 0, 1.0f);
+    skybox.program = skyboxShader.getId();
+    skybox.vertexArray = skyboxVAO;
+    skybox.textureTarget = GL_TEXTURE_CUBE_MAP;
+    skybox.texture = cubemapTexture;
+    skybox.depthFunc = GL_LEQUAL;
+    skybox.count = 36;
+    queue.submit(skybox);
+
+    // Visible spheres with one instanced draw per mesh in use
+    switch (targetDrawMode) {
+    case TARGET_DRAW_LOD:
+        for (size_t level = 0; level < TargetLodRenderer::LEVEL_COUNT; ++level) {
+            submitTargets(lods.getLevel(level), sphereShader, sphereShininess);
+        }
+        break;
+    case TARGET_DRAW_IMPOSTOR:
+        submitTargets(targetImpostors, sphereImpostorShader, sphereImpostorShininess);
+        break;
+    default:
+        submitTargets(fixed, sphereShader, sphereShininess);
+        break;
+    }
+
+    if (gunVisible) {
+        submitGunModel(queue, modelShader, modelUniforms, gunModel, glm::length(gunModel.getPosition() - camera.position) / 100.0f);
+    }
+
+    // Crosshair (depth test off so it's always on top)
+    DrawCommand crosshair;
+    crosshair.key = RenderQueue::makeKey(PASS_OVERLAY, crosshairShader.getId(), crosshairVAO, 0, 0.0f);
+    crosshair.program = crosshairShader.getId();
+    crosshair.vertexArray = crosshairVAO;
+    crosshair.depthTest = false;
+    crosshair.lineWidth = 2.0f;
+    crosshair.mode = GL_LINES;
+    crosshair.count = 4;
+    crosshair.indexed = false;
+    queue.submit(crosshair);
+
+    // Code outside the queue may have changed bindings since the last frame
+    state.invalidate();
+    state.resetCounters();
+    queue.execute(state);
+}
+
+const GLStateCache& FrameRenderer::getStateCache() const {
+    return state;
+}
+
+void FrameRenderer::setSkyboxFirst(bool first) {
+    skyboxFirst = first;
+}
+
+bool FrameRenderer::getSkyboxFirst() const {
+    return skyboxFirst;
+}
+
+const CullStats& FrameRenderer::getCullStats() const {
+    return cullStats;
+}
+
+void FrameRenderer::setTargetDrawMode(TargetDrawMode mode) {
+    targetDrawMode = mode;
+}
+
+TargetDrawMode FrameRenderer::getTargetDrawMode() const {
+    return targetDrawMode;
+}
+
+void FrameRenderer::setTargetShape(SphereShape shape) {
+    targetShape = shape;
+}
+
+SphereShape FrameRenderer::getTargetShape() const {
+    return targetShape;
+}
+
+size_t FrameRenderer::getTargetTriangleCount() const {
+    const TargetRenderer& fixed = targetShape == SPHERE_SHAPE_ICO ? targetIcoRenderer : targetRenderer;
+    const TargetLodRenderer& lods = targetShape == SPHERE_SHAPE_ICO ? targetIcoLods : targetLods;
+    switch (targetDrawMode) {
+    case TARGET_DRAW_LOD:
+        return lods.getTriangleCount();
+    case TARGET_DRAW_IMPOSTOR:
+        return targetImpostors.getInstanceCount() * targetImpostors.getIndexCount() / 3;
+    default:
+        return fixed.getInstanceCount() * fixed.getIndexCount() / 3;
+    }
+}
+
+void FrameRenderer::submitTargets(const TargetRenderer& renderer, ShaderProgram& program, int shininess) {
+    if (renderer.getInstanceCount() == 0) {
+        return;
+    }
+    DrawCommand targets;
+    targets.key = RenderQueue::makeKey(PASS_OPAQUE, program.getId(), renderer.getVAO(), 0, 0.0f);
+    targets.program = program.getId();
+    targets.vertexArray = renderer.getVAO();
+    targets.count = (int)renderer.getIndexCount();
+    targets.indexType = renderer.getIndexType();
+    targets.instanceCount = (int)renderer.getInstanceCount();
+    targets.setup = [&program, shininess]() { program.setFloat(shininess, 32.0f); };
+    queue.submit(targets);
+}
+
+void animateLights(std::vector<Light>& lights, float time) {
+    if (lights.size() < 3) {
+        return;
+    }
+
+    lights[0].setPosition(glm::vec3(sinf(time) * 3.0f, cosf(time) * 2.0f, 3.0f));
+    lights[1].setPosition(glm::vec3(3.0f, sinf(time * 0.7f) * 2.0f, cosf(time * 0.5f) * 3.0f));
+    lights[2].setPosition(glm::vec3(-3.0f, sinf(time * 0.7f) * 2.0f, -cosf(time * 0.5f) * 3.0f));
+}
+
+void placeGunModel(Model& gunModel, const Camera& camera) {
+    glm::vec3 cameraRight = glm::normalize(glm::cross(camera.front, camera.up));
+    glm::vec3 gunOffset = cameraRight * 0.3f + camera.up * (-0.2f) + camera.front * 0.5f;
+    glm::vec3 gunPos = camera.position + gunOffset;
+
+    gunModel.setPosition(gunPos);
+
+    // Use direct camera rotation values
+    glm::vec3 gunRotation = { camera.pitch, -camera.yaw, 90.0f };
+
+    gunModel.setRotation(gunRotation);
+
+    // Appropriate scale for weapon
+    gunModel.setScale(glm::vec3(0.08f, 0.08f, 0.08f));
+}
+
+void submitGunModel(RenderQueue& queue, ShaderProgram& modelShader, const ModelUniforms& uniforms,
+    const Model& gunModel, float depth) {
+
+    // The matrices come from the instance buffer bound to the gun's vertex
+    // arrays and the materials from the Materials block, so a draw only sets
+    // its entry's index.
+
+    // Submeshes share the mesh's vertex array, so they sort next to each
+    // other and bind it once
+    const std::vector<Mesh>& meshes = gunModel.getMeshes();
+    for (const Mesh& mesh : meshes) {
+        for (const Submesh& submesh : mesh.submeshes) {
+            int material = MaterialBuffer::slot(submesh.material);
+            DrawCommand command;
+            command.key = RenderQueue::makeKey(PASS_OPAQUE, modelShader.getId(), mesh.VAO, submesh.material, depth);
+            command.program = modelShader.getId();
+            command.vertexArray = mesh.VAO;
+            command.count = (int)submesh.indexCount;
+            command.firstIndex = submesh.firstIndex;
+            command.instanceCount = 1;
+            command.setup = [&modelShader, &uniforms, material]() {
+                modelShader.setInt(uniforms.hasTexture, 0);
+                modelShader.setInt(uniforms.materialIndex, material);
+            };
+            queue.submit(command);
+        }
+    }
+}
+
+// Load cubemap with enhanced error reporting
+unsigned int loadCubemap(std::vector<std::string> faces) {
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+
+    stbi_set_flip_vertically_on_load(false);
+
+    int width, height, nrChannels;
+    bool loadedAny = false;
+
+    for (unsigned int i = 0; i < faces.size(); i++) {
+        LOG_INFO("Loading face: %s", faces[i].c_str());
+        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
+        if (data) {
+            loadedAny = true;
+            GLenum format = GL_RGB;
+            if (nrChannels == 1)
+                format = GL_RED;
+            else if (nrChannels == 3)
+                format = GL_RGB;
+            else if (nrChannels == 4)
+                format = GL_RGBA;
+
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format,
+                width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            stbi_image_free(data);
+            LOG_INFO("  Success - Format: %s", format == GL_RGB ? "RGB" :
+                (format == GL_RGBA ? "RGBA" : "Other"));
+        }
+        else {
+            LOG_ERROR("  Failed to load texture: %s", faces[i].c_str());
+            LOG_ERROR("  Reason: %s", stbi_failure_reason());
+        }
+    }
+
+    if (!loadedAny) {
+        LOG_ERROR("Failed to load ANY skybox textures!");
+        unsigned char fallback[3] = { 255, 0, 255 };
+        for (unsigned int i = 0; i < 6; i++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, 1, 1, 0,
+                GL_RGB, GL_UNSIGNED_BYTE, fallback);
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    return textureID;
+}
@@ -0,0 +1,159 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include "Sphere.h"
+#include "Light.h"
+#include "LightBuffer.h"
+#include "MaterialBuffer.h"
+#include "CameraBuffer.h"
+#include "TransformSystem.h"
+#include "Frustum.h"
+#include "RenderQueue.h"
+#include "GLStateCache.h"
+#include "Model.h"
+#include "TargetRenderer.h"
+#include "TargetLod.h"
+#include "ShaderProgram.h"
+
+// Camera state captured once per frame
+struct Camera {
+    glm::vec3 position;
+    glm::vec3 front;
+    glm::vec3 up;
+    float yaw;
+    float pitch;
+};
+
+// Uniform handles of the gun model program
+struct ModelUniforms {
+    explicit ModelUniforms(const ShaderProgram& program);
+
+    int materialIndex, hasTexture;
+};
+
+// Objects tested against the view frustum during the last frame
+struct CullStats {
+    size_t targetsVisible, targetsCulled;
+    size_t modelsVisible, modelsCulled;
+};
+
+// How the targets are drawn
+enum TargetDrawMode {
+    TARGET_DRAW_FIXED,    // every target with the 36x18 mesh
+    TARGET_DRAW_LOD,      // mesh detail picked from the target's screen size
+    TARGET_DRAW_IMPOSTOR  // one ray-cast quad per target, for stress fields
+};
+
+// Owns the shaders and static geometry of one game frame so the windowed
+// game and the offscreen benchmark draw exactly the same thing
+class FrameRenderer {
+public:
+    // Compiles all frame shaders and loads the skybox cubemap from the given faces
+    FrameRenderer(const std::vector<std::string>& skyboxFaces);
+
+    // Destructor to clean up OpenGL resources
+    ~FrameRenderer();
+
+    // Draws skybox, spheres, gun and crosshair into the currently bound framebuffer;
+    // time is the animation clock exposed to shaders through the camera block
+    void render(const Camera& camera, std::vector<Sphere>& spheres,
+        std::vector<Light>& lights, Model& gunModel, float aspect, float time);
+
+    // GL calls issued and skipped by the state cache during the last frame
+    const GLStateCache& getStateCache() const;
+
+    // Draws the skybox before the opaque geometry instead of after it.
+    // The image is the same either way; sky-last lets the depth test reject
+    // the cubemap fetch for every pixel already covered, so toggling this
+    // measures the fill rate it saves.
+    void setSkyboxFirst(bool first);
+    bool getSkyboxFirst() const;
+
+    // Visible and culled counts of the last frame
+    const CullStats& getCullStats() const;
+
+    // TARGET_DRAW_LOD unless changed. Impostors are exact spheres with
+    // correct depth at four vertices each, matching the hit test's silhouette.
+    void setTargetDrawMode(TargetDrawMode mode);
+    TargetDrawMode getTargetDrawMode() const;
+
+    // SPHERE_SHAPE_ICO unless changed; it reaches the UV meshes' silhouette
+    // error with fewer triangles and better vertex cache reuse
+    void setTargetShape(SphereShape shape);
+    SphereShape getTargetShape() const;
+
+    // Triangles in the last frame's target draws
+    size_t getTargetTriangleCount() const;
+
+private:
+    // Queues one instanced draw of the renderer's targets, if it has any
+    void submitTargets(const TargetRenderer& renderer, ShaderProgram& program, int shininess);
+
+    // Shader programs
+    ShaderProgram skyboxShader;
+    ShaderProgram sphereShader;
+    ShaderProgram sphereImpostorShader;
+    ShaderProgram modelShader;
+    ShaderProgram crosshairShader;
+
+    // Uniform handles, resolved once after linking
+    int sphereShininess;
+    int sphereImpostorShininess;
+    ModelUniforms modelUniforms;
+
+    // Per-frame blocks shared by every program
+    CameraBuffer cameraBuffer;
+    LightBuffer lightBuffer;
+    MaterialBuffer materialBuffer; // the gun's; uploaded on the first frame only
+
+    // Static geometry
+    unsigned int skyboxVAO, skyboxVBO, skyboxEBO;
+    unsigned int crosshairVAO, crosshairVBO;
+    unsigned int cubemapTexture;
+    bool skyboxFirst;
+    TargetDrawMode targetDrawMode;
+    SphereShape targetShape;
+
+    // Visible spheres in one instanced draw, one per detail level, or as
+    // impostors; the fixed and per-level meshes exist in both shapes
+    TargetRenderer targetRenderer;
+    TargetRenderer targetIcoRenderer;
+    TargetLodRenderer targetLods;
+    TargetLodRenderer targetIcoLods;
+    TargetRenderer targetImpostors;
+
+    // Target bounds gathered for the culling pass and the indices that survive it
+    std::vector<float> boundsX, boundsY, boundsZ, boundsRadius;
+    std::vector<unsigned int> visibleTargets;
+    CullStats cullStats;
+
+    // World, normal and MVP matrices of the non-instanced objects, read by
+    // their draws from the instance buffer
+    TransformSystem transforms;
+    size_t gunTransform;
+    std::vector<unsigned int> gunVertexArrays; // already pointed at gunTransform
+
+    // Draws of the current frame and the state they leave behind
+    RenderQueue queue;
+    GLStateCache state;
+};
+
+// Moves the first three lights along their scripted paths
+void animateLights(std::vector<Light>& lights, float time);
+
+// Places and scales the gun in the bottom-right of the view and aligns it with the camera
+void placeGunModel(Model& gunModel, const Camera& camera);
+
+// Queues one draw per gun submesh with its material index; the matrices come
+// from the transform instance buffer and camera, lights and materials from the
+// shared blocks. depth is the 0..1 sort distance.
+void submitGunModel(RenderQueue& queue, ShaderProgram& modelShader, const ModelUniforms& uniforms,
+    const Model& gunModel, float depth);
+
+// Load cubemap with enhanced error reporting
+unsigned int loadCubemap(std::vector<std::string> faces);
+
+#endif // FRAME_H
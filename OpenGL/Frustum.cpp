@@ -0,0 +1,134 @@
+#include "Frustum.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FRUSTUM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline bool sphereInside(const glm::vec4* planes, float x, float y, float z, float r) {
+    for (int p = 0; p < 6; ++p) {
+        if (planes[p].x * x + planes[p].y * y + planes[p].z * z + planes[p].w < -r) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void scalarRange(const glm::vec4* planes, const float* cx, const float* cy, const float* cz,
+    const float* r, size_t begin, size_t end, std::vector<unsigned int>& visible) {
+    for (size_t i = begin; i < end; ++i) {
+        if (sphereInside(planes, cx[i], cy[i], cz[i], r[i])) {
+            visible.push_back((unsigned int)i);
+        }
+    }
+}
+
+#ifdef FRUSTUM_SSE2
+
+void sse2Range(const glm::vec4* planes, const float* cx, const float* cy, const float* cz,
+    const float* r, size_t count, std::vector<unsigned int>& visible) {
+    __m128 px[6], py[6], pz[6], pw[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm_set1_ps(planes[p].x);
+        py[p] = _mm_set1_ps(planes[p].y);
+        pz[p] = _mm_set1_ps(planes[p].z);
+        pw[p] = _mm_set1_ps(planes[p].w);
+    }
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    size_t blocks = count & ~(size_t)3;
+    for (size_t i = 0; i < blocks; i += 4) {
+        __m128 x = _mm_loadu_ps(cx + i);
+        __m128 y = _mm_loadu_ps(cy + i);
+        __m128 z = _mm_loadu_ps(cz + i);
+        __m128 negR = _mm_xor_ps(_mm_loadu_ps(r + i), signBit);
+
+        // A lane stays set while its sphere is not fully behind any plane
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y)),
+                _mm_mul_ps(pz[p], z)), pw[p]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negR));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        while (mask) {
+            int lane = 0;
+            while (!(mask & (1 << lane))) {
+                ++lane;
+            }
+            visible.push_back((unsigned int)(i + lane));
+            mask &= mask - 1;
+        }
+    }
+
+    scalarRange(planes, cx, cy, cz, r, blocks, count, visible);
+}
+
+#endif // FRUSTUM_SSE2
+
+} // namespace
+
+BoundingSphere transformBounds(const BoundingSphere& bounds, const glm::mat4& transform) {
+    float scale = std::sqrt(std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+        std::max(glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+            glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2])))));
+    BoundingSphere result;
+    result.center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+    result.radius = bounds.radius * scale;
+    return result;
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProj) {
+    // Rows of the matrix; each plane is the fourth row plus or minus another
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i) {
+        row[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0];
+    frustum.planes[1] = row[3] - row[0];
+    frustum.planes[2] = row[3] + row[1];
+    frustum.planes[3] = row[3] - row[1];
+    frustum.planes[4] = row[3] + row[2];
+    frustum.planes[5] = row[3] - row[2];
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere& bounds) const {
+    return sphereInside(planes, bounds.center.x, bounds.center.y, bounds.center.z, bounds.radius);
+}
+
+size_t cullSpheres(const Frustum& frustum, const float* centerX, const float* centerY,
+    const float* centerZ, const float* radius, size_t count, std::vector<unsigned int>& visible) {
+    size_t before = visible.size();
+#ifdef FRUSTUM_SSE2
+    sse2Range(frustum.planes, centerX, centerY, centerZ, radius, count, visible);
+#else
+    scalarRange(frustum.planes, centerX, centerY, centerZ, radius, 0, count, visible);
+#endif
+    return visible.size() - before;
+}
+
+size_t cullSpheresScalar(const Frustum& frustum, const float* centerX, const float* centerY,
+    const float* centerZ, const float* radius, size_t count, std::vector<unsigned int>& visible) {
+    size_t before = visible.size();
+    scalarRange(frustum.planes, centerX, centerY, centerZ, radius, 0, count, visible);
+    return visible.size() - before;
+}
+
+const char* cullSpheresKernel() {
+#ifdef FRUSTUM_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
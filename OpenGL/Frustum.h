@@ -0,0 +1,43 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Sphere enclosing an object, in whatever space its owner documents
+struct BoundingSphere {
+    glm::vec3 center;
+    float radius;
+};
+
+// Bounds after an affine transform; the radius grows by the largest axis scale
+BoundingSphere transformBounds(const BoundingSphere& bounds, const glm::mat4& transform);
+
+// The six clip planes of a view-projection matrix, normals pointing inward
+// and normalized so plane distances are in world units
+struct Frustum {
+    glm::vec4 planes[6]; // left, right, bottom, top, near, far
+
+    static Frustum fromMatrix(const glm::mat4& viewProj);
+
+    // False only when the sphere lies entirely outside one plane. Spheres
+    // near a frustum corner can pass while being outside; they are drawn.
+    bool intersects(const BoundingSphere& bounds) const;
+};
+
+// Appends the indices of the spheres (stored as separate x/y/z/radius
+// arrays) that intersect the frustum to visible, in ascending order, and
+// returns how many were appended. Tests four spheres per step with SSE2
+// when available, else scalar.
+size_t cullSpheres(const Frustum& frustum, const float* centerX, const float* centerY,
+    const float* centerZ, const float* radius, size_t count, std::vector<unsigned int>& visible);
+
+// Reference implementation of cullSpheres without SIMD
+size_t cullSpheresScalar(const Frustum& frustum, const float* centerX, const float* centerY,
+    const float* centerZ, const float* radius, size_t count, std::vector<unsigned int>& visible);
+
+// Name of the kernel cullSpheres uses ("sse2" or "scalar")
+const char* cullSpheresKernel();
+
+#endif // FRUSTUM_H
@@ -0,0 +1,125 @@
+#include "GLStateCache.h"
+#include <glad/glad.h>
+
+namespace {
+
+// Shadow value meaning "not known", never a valid GL name or enum
+const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+} // namespace
+
+GLStateCache::GLStateCache() : capabilityCount(0), issuedCalls(0), savedCalls(0) {
+    invalidate();
+}
+
+bool GLStateCache::changed(unsigned int& shadow, unsigned int value) {
+    if (shadow == value) {
+        ++savedCalls;
+        return false;
+    }
+    shadow = value;
+    ++issuedCalls;
+    return true;
+}
+
+void GLStateCache::useProgram(unsigned int id) {
+    if (changed(program, id)) {
+        glUseProgram(id);
+    }
+}
+
+void GLStateCache::bindVertexArray(unsigned int id) {
+    if (changed(vertexArray, id)) {
+        glBindVertexArray(id);
+    }
+}
+
+void GLStateCache::bindTexture(unsigned int unit, unsigned int target, unsigned int texture) {
+    if (unit >= (unsigned int)MAX_TEXTURE_UNITS) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        activeUnit = UNKNOWN;
+        issuedCalls += 2;
+        return;
+    }
+    if (textures[unit] == texture && textureTargets[unit] == target) {
+        ++savedCalls;
+        return;
+    }
+    if (changed(activeUnit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    textures[unit] = texture;
+    textureTargets[unit] = target;
+    ++issuedCalls;
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::setEnabled(unsigned int capability, bool enabled) {
+    int slot = 0;
+    while (slot < capabilityCount && capabilities[slot] != capability) {
+        ++slot;
+    }
+    if (slot == capabilityCount && capabilityCount < MAX_CAPABILITIES) {
+        capabilities[capabilityCount] = capability;
+        capabilityStates[capabilityCount] = UNKNOWN;
+        ++capabilityCount;
+    }
+
+    unsigned int untracked = UNKNOWN;
+    unsigned int& shadow = slot < capabilityCount ? capabilityStates[slot] : untracked;
+    if (changed(shadow, enabled ? 1u : 0u)) {
+        if (enabled) {
+            glEnable(capability);
+        }
+        else {
+            glDisable(capability);
+        }
+    }
+}
+
+void GLStateCache::depthFunc(unsigned int func) {
+    if (changed(depthFunction, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void GLStateCache::lineWidth(float value) {
+    if (hasWidth && width == value) {
+        ++savedCalls;
+        return;
+    }
+    width = value;
+    hasWidth = true;
+    ++issuedCalls;
+    glLineWidth(value);
+}
+
+void GLStateCache::invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+        textures[i] = UNKNOWN;
+        textureTargets[i] = UNKNOWN;
+    }
+    for (int i = 0; i < capabilityCount; ++i) {
+        capabilityStates[i] = UNKNOWN;
+    }
+    depthFunction = UNKNOWN;
+    width = 0.0f;
+    hasWidth = false;
+}
+
+size_t GLStateCache::getIssuedCalls() const {
+    return issuedCalls;
+}
+
+size_t GLStateCache::getSavedCalls() const {
+    return savedCalls;
+}
+
+void GLStateCache::resetCounters() {
+    issuedCalls = 0;
+    savedCalls = 0;
+}
@@ -0,0 +1,53 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <cstddef>
+
+// Shadows the GL state the frame changes most (program, vertex array,
+// texture bindings, capabilities, depth function, line width) and drops
+// calls that would set a value that is already current. The shadow is only
+// valid while every change of that state goes through the cache; call
+// invalidate() after code that bypasses it.
+class GLStateCache {
+public:
+    GLStateCache();
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vertexArray);
+    void bindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+    void setEnabled(unsigned int capability, bool enabled);
+    void depthFunc(unsigned int func);
+    void lineWidth(float width);
+
+    // Forgets all shadowed state so the next call of each kind is issued
+    void invalidate();
+
+    // GL calls issued and skipped since the last resetCounters()
+    size_t getIssuedCalls() const;
+    size_t getSavedCalls() const;
+    void resetCounters();
+
+private:
+    static const int MAX_TEXTURE_UNITS = 16;
+    static const int MAX_CAPABILITIES = 8;
+
+    // Returns true when value differs from the shadow, and updates it
+    bool changed(unsigned int& shadow, unsigned int value);
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int activeUnit;
+    unsigned int textures[MAX_TEXTURE_UNITS];
+    unsigned int textureTargets[MAX_TEXTURE_UNITS];
+    unsigned int capabilities[MAX_CAPABILITIES];
+    unsigned int capabilityStates[MAX_CAPABILITIES];
+    int capabilityCount;
+    unsigned int depthFunction;
+    float width;
+    bool hasWidth;
+
+    size_t issuedCalls;
+    size_t savedCalls;
+};
+
+#endif // GL_STATE_CACHE_H
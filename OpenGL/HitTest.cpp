@@ -0,0 +1,335 @@
+#include "HitTest.h"
+#include "Log.h"
+#include <cmath>
+
+// CORRECTED ray-sphere intersection function
+bool raySphereIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    const glm::vec3& sphereCenter, float sphereRadius, float* t_out) {
+
+    // Vector from ray origin to sphere center
+    glm::vec3 oc = rayOrigin - sphereCenter;
+
+    // Quadratic equation coefficients: at² + bt + c = 0
+    // where t is the parameter along the ray
+    float a = glm::dot(rayDir, rayDir);  // Should be 1.0 for normalized ray
+    float b = 2.0f * glm::dot(oc, rayDir);
+    float c = glm::dot(oc, oc) - sphereRadius * sphereRadius;
+
+    // Calculate discriminant
+    float discriminant = b * b - 4 * a * c;
+
+    // Debug output with CORRECT format
+    LOG_TRACE("    === Ray-Sphere Intersection Debug ===");
+    LOG_TRACE("    Ray Origin: (%g, %g, %g)", rayOrigin.x, rayOrigin.y, rayOrigin.z);
+    LOG_TRACE("    Ray Direction: (%g, %g, %g)", rayDir.x, rayDir.y, rayDir.z);
+    LOG_TRACE("    Sphere Center: (%g, %g, %g)", sphereCenter.x, sphereCenter.y, sphereCenter.z);
+    LOG_TRACE("    Sphere Radius: %g", sphereRadius);
+    LOG_TRACE("    Distance to sphere center: %g", glm::length(oc));
+    LOG_TRACE("    a: %g, b: %g, c: %g", a, b, c);
+    LOG_TRACE("    Discriminant: %g", discriminant);
+
+    if (discriminant < 0) {
+        LOG_TRACE("    No intersection (discriminant < 0)");
+        return false;
+    }
+
+    // Calculate both intersection points
+    float sqrtDiscriminant = sqrt(discriminant);
+    float t1 = (-b - sqrtDiscriminant) / (2.0f * a);
+    float t2 = (-b + sqrtDiscriminant) / (2.0f * a);
+
+    LOG_TRACE("    t1: %g, t2: %g", t1, t2);
+
+    // We want the closest positive intersection (in front of camera)
+    float t = (t1 > 0) ? t1 : t2;
+
+    if (t > 0) {
+        LOG_TRACE("    Intersection at t=%g, point: (%g, %g, %g)", t,
+            rayOrigin.x + t * rayDir.x, rayOrigin.y + t * rayDir.y, rayOrigin.z + t * rayDir.z);
+        LOG_TRACE("    HIT DETECTED!");
+
+        if (t_out) *t_out = t;
+        return true;
+    }
+
+    LOG_TRACE("    No positive intersection");
+    return false;
+}
+
+void Hitting(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    const glm::vec3& sphereCenter, float sphereRadius, float tolerance) {
+
+    // Ensure ray direction is normalized
+    glm::vec3 normalizedRayDir = rayDir;
+
+    // Vector from ray origin to sphere center
+    glm::vec3 toCenter = sphereCenter - rayOrigin;
+
+    // Project toCenter onto the ray direction to find closest point
+    float projection = glm::dot(toCenter, normalizedRayDir);
+
+    // Calculate the closest point on the ray to the sphere center
+    glm::vec3 closestPoint = rayOrigin + projection * normalizedRayDir;
+
+    // Calculate distance from closest point to sphere center
+    float distToCenter = glm::length(closestPoint - sphereCenter);
+
+    // Check if we're within tolerance
+    bool hit = distToCenter <= (sphereRadius + tolerance);
+
+    // Debug output
+    LOG_TRACE("    === Hitscan with Tolerance Debug ===");
+    LOG_TRACE("    Projection: %g", projection);
+    LOG_TRACE("    Closest point: (%g, %g, %g)", closestPoint.x, closestPoint.y, closestPoint.z);
+    LOG_TRACE("    Distance to center: %g", distToCenter);
+    LOG_TRACE("    Radius + tolerance: %g", sphereRadius + tolerance);
+    LOG_TRACE("    Hit: %s", hit ? "YES" : "NO");
+    (void)hit;
+}
+
+// ---------------------------------------------------------------------------
+// Batched closest-hit kernels
+//
+// With a normalized direction the quadratic reduces to t = -b -/+ sqrt(b*b - c)
+// where b = dot(o - c, d) and c = |o - c|^2 - r^2. Like raySphereIntersection,
+// the near root is used when it is in front of the origin, else the far one.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HIT_TEST_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HIT_TEST_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HIT_TEST_TARGET_AVX2
+#endif
+
+namespace {
+
+// Hit distance for one target, or INFINITY on a miss
+inline float sphereHitT(float cx, float cy, float cz, float r, const glm::vec3& o, const glm::vec3& d) {
+    float ox = o.x - cx;
+    float oy = o.y - cy;
+    float oz = o.z - cz;
+    float b = ox * d.x + oy * d.y + oz * d.z;
+    float c = ox * ox + oy * oy + oz * oz - r * r;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0f) {
+        return INFINITY;
+    }
+    float s = std::sqrt(discriminant);
+    float t = (-b - s > 0.0f) ? -b - s : -b + s;
+    return t > 0.0f ? t : INFINITY;
+}
+
+inline void scalarRange(const float* cx, const float* cy, const float* cz, const float* r,
+    size_t begin, size_t end, const glm::vec3& o, const glm::vec3& d, float tolerance, RayHit& best) {
+    for (size_t i = begin; i < end; ++i) {
+        float t = sphereHitT(cx[i], cy[i], cz[i], r[i] + tolerance, o, d);
+        if (t < best.t) {
+            best.t = t;
+            best.index = (int)i;
+        }
+    }
+}
+
+#ifdef HIT_TEST_X86
+
+// Picks the smallest t across lanes, lowest index on ties
+inline void reduceLanes(const float* laneT, const int* laneIndex, int lanes, RayHit& best) {
+    for (int lane = 0; lane < lanes; ++lane) {
+        if (laneIndex[lane] < 0) {
+            continue;
+        }
+        if (laneT[lane] < best.t || (laneT[lane] == best.t && laneIndex[lane] < best.index)) {
+            best.t = laneT[lane];
+            best.index = laneIndex[lane];
+        }
+    }
+}
+
+void sse2Range(const float* cx, const float* cy, const float* cz, const float* r,
+    size_t count, const glm::vec3& o, const glm::vec3& d, float tolerance, RayHit& best) {
+    const __m128 ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y), oz = _mm_set1_ps(o.z);
+    const __m128 dx = _mm_set1_ps(d.x), dy = _mm_set1_ps(d.y), dz = _mm_set1_ps(d.z);
+    const __m128 tol = _mm_set1_ps(tolerance);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    __m128 bestT = _mm_set1_ps(INFINITY);
+    __m128i bestIndex = _mm_set1_epi32(-1);
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(4);
+
+    size_t blocks = count & ~(size_t)3;
+    for (size_t i = 0; i < blocks; i += 4) {
+        __m128 px = _mm_sub_ps(ox, _mm_loadu_ps(cx + i));
+        __m128 py = _mm_sub_ps(oy, _mm_loadu_ps(cy + i));
+        __m128 pz = _mm_sub_ps(oz, _mm_loadu_ps(cz + i));
+        __m128 rr = _mm_add_ps(_mm_loadu_ps(r + i), tol);
+
+        __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, dx), _mm_mul_ps(py, dy)), _mm_mul_ps(pz, dz));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz)),
+            _mm_mul_ps(rr, rr));
+        __m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), c);
+        __m128 s = _mm_sqrt_ps(_mm_max_ps(discriminant, zero));
+        __m128 negB = _mm_xor_ps(b, signBit);
+        __m128 tNear = _mm_sub_ps(negB, s);
+        __m128 tFar = _mm_add_ps(negB, s);
+        __m128 nearValid = _mm_cmpgt_ps(tNear, zero);
+        __m128 t = _mm_or_ps(_mm_and_ps(nearValid, tNear), _mm_andnot_ps(nearValid, tFar));
+
+        __m128 closer = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(discriminant, zero), _mm_cmpgt_ps(t, zero)),
+            _mm_cmplt_ps(t, bestT));
+        bestT = _mm_or_ps(_mm_and_ps(closer, t), _mm_andnot_ps(closer, bestT));
+        __m128i closerMask = _mm_castps_si128(closer);
+        bestIndex = _mm_or_si128(_mm_and_si128(closerMask, index), _mm_andnot_si128(closerMask, bestIndex));
+        index = _mm_add_epi32(index, step);
+    }
+
+    alignas(16) float laneT[4];
+    alignas(16) int laneIndex[4];
+    _mm_store_ps(laneT, bestT);
+    _mm_store_si128((__m128i*)laneIndex, bestIndex);
+    reduceLanes(laneT, laneIndex, 4, best);
+
+    scalarRange(cx, cy, cz, r, blocks, count, o, d, tolerance, best);
+}
+
+HIT_TEST_TARGET_AVX2
+void avx2Range(const float* cx, const float* cy, const float* cz, const float* r,
+    size_t count, const glm::vec3& o, const glm::vec3& d, float tolerance, RayHit& best) {
+    const __m256 ox = _mm256_set1_ps(o.x), oy = _mm256_set1_ps(o.y), oz = _mm256_set1_ps(o.z);
+    const __m256 dx = _mm256_set1_ps(d.x), dy = _mm256_set1_ps(d.y), dz = _mm256_set1_ps(d.z);
+    const __m256 tol = _mm256_set1_ps(tolerance);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 bestT = _mm256_set1_ps(INFINITY);
+    __m256i bestIndex = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+
+    size_t blocks = count & ~(size_t)7;
+    for (size_t i = 0; i < blocks; i += 8) {
+        __m256 px = _mm256_sub_ps(ox, _mm256_loadu_ps(cx + i));
+        __m256 py = _mm256_sub_ps(oy, _mm256_loadu_ps(cy + i));
+        __m256 pz = _mm256_sub_ps(oz, _mm256_loadu_ps(cz + i));
+        __m256 rr = _mm256_add_ps(_mm256_loadu_ps(r + i), tol);
+
+        __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, dx), _mm256_mul_ps(py, dy)), _mm256_mul_ps(pz, dz));
+        __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)),
+            _mm256_mul_ps(pz, pz)), _mm256_mul_ps(rr, rr));
+        __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), c);
+        __m256 s = _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero));
+        __m256 negB = _mm256_xor_ps(b, signBit);
+        __m256 tNear = _mm256_sub_ps(negB, s);
+        __m256 tFar = _mm256_add_ps(negB, s);
+        __m256 t = _mm256_blendv_ps(tFar, tNear, _mm256_cmp_ps(tNear, zero, _CMP_GT_OQ));
+
+        __m256 closer = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ),
+            _mm256_cmp_ps(t, zero, _CMP_GT_OQ)), _mm256_cmp_ps(t, bestT, _CMP_LT_OQ));
+        bestT = _mm256_blendv_ps(bestT, t, closer);
+        bestIndex = _mm256_blendv_epi8(bestIndex, index, _mm256_castps_si256(closer));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    alignas(32) float laneT[8];
+    alignas(32) int laneIndex[8];
+    _mm256_store_ps(laneT, bestT);
+    _mm256_store_si256((__m256i*)laneIndex, bestIndex);
+    reduceLanes(laneT, laneIndex, 8, best);
+
+    scalarRange(cx, cy, cz, r, blocks, count, o, d, tolerance, best);
+}
+
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // HIT_TEST_X86
+
+enum Kernel { KernelScalar, KernelSSE2, KernelAVX2 };
+
+Kernel selectKernel() {
+#ifdef HIT_TEST_X86
+    static const Kernel kernel = cpuHasAvx2() ? KernelAVX2 : KernelSSE2;
+    return kernel;
+#else
+    return KernelScalar;
+#endif
+}
+
+} // namespace
+
+RayHit closestRaySphereHit(const float* centerX, const float* centerY, const float* centerZ,
+    const float* radius, size_t count, const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    float tolerance) {
+    RayHit best = { -1, INFINITY };
+    switch (selectKernel()) {
+#ifdef HIT_TEST_X86
+    case KernelAVX2:
+        avx2Range(centerX, centerY, centerZ, radius, count, rayOrigin, rayDir, tolerance, best);
+        break;
+    case KernelSSE2:
+        sse2Range(centerX, centerY, centerZ, radius, count, rayOrigin, rayDir, tolerance, best);
+        break;
+#endif
+    default:
+        scalarRange(centerX, centerY, centerZ, radius, 0, count, rayOrigin, rayDir, tolerance, best);
+        break;
+    }
+    return best;
+}
+
+RayHit closestRaySphereHitScalar(const float* centerX, const float* centerY, const float* centerZ,
+    const float* radius, size_t count, const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    float tolerance) {
+    RayHit best = { -1, INFINITY };
+    scalarRange(centerX, centerY, centerZ, radius, 0, count, rayOrigin, rayDir, tolerance, best);
+    return best;
+}
+
+void closestRaySphereHitSubset(const float* centerX, const float* centerY, const float* centerZ,
+    const float* radius, const unsigned int* indices, size_t count, const glm::vec3& rayOrigin,
+    const glm::vec3& rayDir, float tolerance, RayHit& best) {
+    for (size_t k = 0; k < count; ++k) {
+        unsigned int i = indices[k];
+        float t = sphereHitT(centerX[i], centerY[i], centerZ[i], radius[i] + tolerance, rayOrigin, rayDir);
+        if (t < best.t || (t == best.t && (int)i < best.index)) {
+            best.t = t;
+            best.index = (int)i;
+        }
+    }
+}
+
+const char* closestRaySphereHitKernel() {
+    switch (selectKernel()) {
+    case KernelAVX2: return "avx2";
+    case KernelSSE2: return "sse2";
+    default: return "scalar";
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef HIT_TEST_H
+#define HIT_TEST_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Ray-sphere intersection; writes the nearest positive t to t_out on a hit
+bool raySphereIntersection(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    const glm::vec3& sphereCenter, float sphereRadius, float* t_out = nullptr);
+
+// Hitscan check with a tolerance band around the sphere (debug output only)
+void Hitting(const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    const glm::vec3& sphereCenter, float sphereRadius, float tolerance = 0.5f);
+
+// Nearest hit of a ray against a batch of spheres; index is -1 on a miss
+struct RayHit {
+    int index;
+    float t;
+};
+
+// Closest-hit test over spheres stored as separate x/y/z/radius arrays.
+// rayDir must be normalized; tolerance is added to every radius. Uses AVX2
+// (8 targets per step) or SSE2 (4 per step) when available, else scalar.
+// Ties resolve to the lowest index, identical to the scalar path.
+RayHit closestRaySphereHit(const float* centerX, const float* centerY, const float* centerZ,
+    const float* radius, size_t count, const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    float tolerance = 0.0f);
+
+// Reference implementation of closestRaySphereHit without SIMD
+RayHit closestRaySphereHitScalar(const float* centerX, const float* centerY, const float* centerZ,
+    const float* radius, size_t count, const glm::vec3& rayOrigin, const glm::vec3& rayDir,
+    float tolerance = 0.0f);
+
+// Scalar closest-hit over the targets listed in indices; only replaces best
+// when a listed target is nearer (or equally near with a lower index)
+void closestRaySphereHitSubset(const float* centerX, const float* centerY, const float* centerZ,
+    const float* radius, const unsigned int* indices, size_t count, const glm::vec3& rayOrigin,
+    const glm::vec3& rayDir, float tolerance, RayHit& best);
+
+// Name of the kernel closestRaySphereHit dispatches to ("avx2", "sse2" or "scalar")
+const char* closestRaySphereHitKernel();
+
+#endif // HIT_TEST_H
@@ -13,9 +13,6 @@ public:
         float diffuse = 0.8f,
         float specular = 1.0f);
 
-    // Update light parameters in shader
-    void updateShader(unsigned int shaderProgram, int lightIndex);
-
     // Getters and setters
     void setPosition(const glm::vec3& newPosition);
     void setColor(const glm::vec3& newColor);
@@ -28,6 +25,9 @@ public:
     float getDiffuse() const;
     float getSpecular() const;
 
+    // Constant, linear and quadratic attenuation factors
+    glm::vec3 getAttenuation() const;
+
     glm::vec3 getPosition() const;
     glm::vec3 getColor() const;
 
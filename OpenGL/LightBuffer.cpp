@@ -0,0 +1,36 @@
+#include "LightBuffer.h"
+#include <cstring>
+
+LightBuffer::LightBuffer() : buffer(sizeof(LightBlock), LIGHT_BUFFER_BINDING) {
+}
+
+void LightBuffer::update(const std::vector<Light>& lights) {
+    LightBlock block;
+    std::memset(&block, 0, sizeof(block));
+
+    size_t count = lights.size() < LIGHT_BUFFER_MAX_LIGHTS ? lights.size() : LIGHT_BUFFER_MAX_LIGHTS;
+    for (size_t i = 0; i < count; ++i) {
+        const Light& light = lights[i];
+        LightData& data = block.lights[i];
+        glm::vec3 attenuation = light.getAttenuation();
+        data.position = light.getPosition();
+        data.ambient = light.getAmbient();
+        data.color = light.getColor();
+        data.diffuse = light.getDiffuse();
+        data.specular = light.getSpecular();
+        data.constant = attenuation.x;
+        data.linear = attenuation.y;
+        data.quadratic = attenuation.z;
+    }
+    block.numLights = (int)count;
+
+    buffer.upload(&block);
+}
+
+size_t LightBuffer::getUploadCount() const {
+    return buffer.getUploadCount();
+}
+
+size_t LightBuffer::getSkippedCount() const {
+    return buffer.getSkippedCount();
+}
@@ -0,0 +1,76 @@
+#ifndef LIGHT_BUFFER_H
+#define LIGHT_BUFFER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "Light.h"
+#include "UniformBuffer.h"
+
+// Lights are shared by every lit program through one uniform buffer
+#define LIGHT_BUFFER_MAX_LIGHTS 8
+#define LIGHT_BUFFER_BINDING 0
+
+#define LIGHT_BUFFER_STRINGIFY_(x) #x
+#define LIGHT_BUFFER_STRINGIFY(x) LIGHT_BUFFER_STRINGIFY_(x)
+
+// GLSL declaration of the block, spliced into the shader sources. Each
+// vec3 is followed by a float so the std140 layout has no padding.
+#define LIGHT_BLOCK_GLSL \
+    "#define MAX_LIGHTS " LIGHT_BUFFER_STRINGIFY(LIGHT_BUFFER_MAX_LIGHTS) "\n" \
+    "struct Light {\n" \
+    "    vec3 position;\n" \
+    "    float ambient;\n" \
+    "    vec3 color;\n" \
+    "    float diffuse;\n" \
+    "    float specular;\n" \
+    "    float constant;\n" \
+    "    float linear;\n" \
+    "    float quadratic;\n" \
+    "};\n" \
+    "layout (std140) uniform Lights {\n" \
+    "    Light lights[MAX_LIGHTS];\n" \
+    "    int numLights;\n" \
+    "};\n"
+
+// CPU mirror of one element of the block
+struct LightData {
+    glm::vec3 position;
+    float ambient;
+    glm::vec3 color;
+    float diffuse;
+    float specular;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// CPU mirror of the whole block
+struct LightBlock {
+    LightData lights[LIGHT_BUFFER_MAX_LIGHTS];
+    int numLights;
+    int padding[3];
+};
+
+static_assert(sizeof(LightData) == 48, "LightData must match the std140 Light struct");
+static_assert(sizeof(LightBlock) == 48 * LIGHT_BUFFER_MAX_LIGHTS + 16, "LightBlock must match the std140 Lights block");
+
+// Packs lights into the "Lights" block at LIGHT_BUFFER_BINDING. Every
+// program compiled by compileSpecialShader reads the same buffer, so one
+// upload per frame serves all of them.
+class LightBuffer {
+public:
+    LightBuffer();
+
+    // Packs the lights and uploads the block with one call if anything changed;
+    // lights past LIGHT_BUFFER_MAX_LIGHTS are ignored
+    void update(const std::vector<Light>& lights);
+
+    // Uploads issued and skipped because the lights were unchanged
+    size_t getUploadCount() const;
+    size_t getSkippedCount() const;
+
+private:
+    UniformBuffer buffer;
+};
+
+#endif // LIGHT_BUFFER_H
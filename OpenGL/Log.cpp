@@ -0,0 +1,159 @@
+#include "Log.h"
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Per-thread ring capacity (power of two) and maximum message length
+const size_t RING_SIZE = 1024;
+const size_t MESSAGE_SIZE = 255;
+
+struct Slot {
+    unsigned char level;
+    char text[MESSAGE_SIZE];
+};
+
+// Single-producer/single-consumer ring: the owning thread advances head,
+// the writer thread advances tail
+struct Ring {
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    Slot slots[RING_SIZE];
+};
+
+class Writer {
+public:
+    Writer() : output(stdout), running(true), dropped(0) {
+        thread = std::thread(&Writer::run, this);
+    }
+
+    ~Writer() {
+        running = false;
+        thread.join();
+        drain();
+        size_t lost = dropped.load(std::memory_order_relaxed);
+        if (lost > 0) {
+            std::fprintf(stderr, "Logger: %zu messages dropped because a ring buffer was full\n", lost);
+        }
+    }
+
+    // Called once per thread on its first message
+    Ring* registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        rings.push_back(std::unique_ptr<Ring>(new Ring()));
+        return rings.back().get();
+    }
+
+    void flush() {
+        std::vector<std::pair<Ring*, size_t>> targets;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (auto& ring : rings) {
+                targets.push_back(std::make_pair(ring.get(), ring->head.load(std::memory_order_acquire)));
+            }
+        }
+        for (auto& target : targets) {
+            while (target.first->tail.load(std::memory_order_acquire) < target.second) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+    std::atomic<FILE*> output;
+    std::atomic<bool> running;
+    std::atomic<size_t> dropped;
+
+private:
+    void run() {
+        while (running) {
+            if (!drain()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+    }
+
+    // Writes out everything currently queued; returns false when idle
+    bool drain() {
+        // Rings are never freed, so the list is copied and written outside
+        // the lock a thread's first message takes to register
+        std::vector<Ring*> targets;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (auto& ring : rings) {
+                targets.push_back(ring.get());
+            }
+        }
+
+        bool wroteAny = false;
+        for (Ring* ring : targets) {
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+            size_t head = ring->head.load(std::memory_order_acquire);
+            while (tail != head) {
+                const Slot& slot = ring->slots[tail & (RING_SIZE - 1)];
+                FILE* stream = slot.level >= Logger::Warn ? stderr : output.load(std::memory_order_relaxed);
+                std::fputs(slot.text, stream);
+                std::fputc('\n', stream);
+                ++tail;
+                ring->tail.store(tail, std::memory_order_release);
+                wroteAny = true;
+            }
+        }
+        if (wroteAny) {
+            std::fflush(output.load(std::memory_order_relaxed));
+        }
+        return wroteAny;
+    }
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::thread thread;
+};
+
+Writer& writer() {
+    static Writer instance;
+    return instance;
+}
+
+thread_local Ring* threadRing = nullptr;
+
+} // namespace
+
+void Logger::write(Level level, const char* format, ...) {
+    Writer& w = writer();
+    if (!threadRing) {
+        threadRing = w.registerThread();
+    }
+
+    Ring& ring = *threadRing;
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        w.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Slot& slot = ring.slots[head & (RING_SIZE - 1)];
+    slot.level = (unsigned char)level;
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(slot.text, MESSAGE_SIZE, format, args);
+    va_end(args);
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Logger::flush() {
+    writer().flush();
+}
+
+void Logger::setOutput(FILE* stream) {
+    writer().output = stream;
+}
+
+size_t Logger::droppedCount() {
+    return writer().dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,81 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <cstddef>
+#include <cstdio>
+
+// Log levels. Anything below LOG_LEVEL is compiled out entirely, so its
+// arguments are never evaluated. Release builds keep warnings and errors only.
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL LOG_LEVEL_WARN
+#else
+#define LOG_LEVEL LOG_LEVEL_TRACE
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOG_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define LOG_PRINTF_FORMAT(fmt, args)
+#endif
+
+// Asynchronous logger. Each thread formats into its own lock-free ring buffer
+// and a background thread writes the rings out, so logging never blocks the
+// caller; when a ring is full the message is dropped and counted instead.
+class Logger {
+public:
+    enum Level { Trace, Debug, Info, Warn, Error };
+
+    // Formats a printf-style message into the calling thread's ring buffer
+    static void write(Level level, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+
+    // Blocks until every message queued before the call has been written
+    static void flush();
+
+    // Stream for trace..info messages (stdout by default); warnings and errors go to stderr
+    static void setOutput(FILE* stream);
+
+    // Number of messages lost because a ring buffer was full; the total is
+    // also printed to stderr when the writer shuts down
+    static size_t droppedCount();
+};
+
+#if LOG_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) Logger::write(Logger::Trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::write(Logger::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::write(Logger::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::write(Logger::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::write(Logger::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,137 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Returned for empty files, which can't be mapped
+static const char emptyFile[1] = { 0 };
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : file(INVALID_HANDLE_VALUE), mapping(NULL), data(nullptr), size(0), opened(false) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    size = (size_t)fileSize.QuadPart;
+    opened = true;
+    if (size == 0) {
+        data = emptyFile;
+        return true;
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (data && data != emptyFile) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : file(-1), data(nullptr), size(0), opened(false) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0) {
+        close();
+        return false;
+    }
+    size = (size_t)info.st_size;
+    opened = true;
+    if (size == 0) {
+        data = emptyFile;
+        return true;
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED) {
+        close();
+        return false;
+    }
+    // Parsers read front to back
+    madvise(view, size, MADV_SEQUENTIAL);
+    data = (const char*)view;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data && data != emptyFile) {
+        munmap((void*)data, size);
+    }
+    if (file >= 0) {
+        ::close(file);
+    }
+    file = -1;
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
+
+const char* MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
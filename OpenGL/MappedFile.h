@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file, memory-mapped so parsers walk the page
+// cache directly instead of copying through stream buffers
+class MappedFile {
+public:
+    MappedFile();
+
+    // Unmaps the file if one is open
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file at path, closing any previous one; returns false if it
+    // can't be opened. An empty file maps to a zero-length view.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const;
+    const char* getData() const;
+    size_t getSize() const;
+
+private:
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#else
+    int file;
+#endif
+    const char* data;
+    size_t size;
+    bool opened;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,49 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "MaterialBuffer.h"
+#include <cstring>
+#include "Log.h"
+#include "Model.h"
+
+namespace {
+
+void pack(MaterialData& data, const Material& material) {
+    data.diffuse = material.diffuse;
+    data.shininess = material.shininess;
+    data.specular = material.specular;
+}
+
+} // namespace
+
+MaterialBuffer::MaterialBuffer() : buffer(sizeof(MaterialBlock), MATERIAL_BUFFER_BINDING), warnedOverflow(false) {
+}
+
+void MaterialBuffer::update(const std::vector<Material>& materials) {
+    MaterialBlock block;
+    std::memset(&block, 0, sizeof(block));
+
+    size_t count = materials.size() < MATERIAL_BUFFER_FALLBACK_SLOT ? materials.size() : MATERIAL_BUFFER_FALLBACK_SLOT;
+    if (count < materials.size() && !warnedOverflow) {
+        LOG_WARN("Model has %zu materials; those past the first %d are drawn with the fallback material",
+            materials.size(), MATERIAL_BUFFER_FALLBACK_SLOT);
+        warnedOverflow = true;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        pack(block.materials[i], materials[i]);
+    }
+    pack(block.materials[MATERIAL_BUFFER_FALLBACK_SLOT], Material::fallback(""));
+
+    buffer.upload(&block);
+}
+
+int MaterialBuffer::slot(unsigned int material) {
+    return material < MATERIAL_BUFFER_FALLBACK_SLOT ? (int)material : MATERIAL_BUFFER_FALLBACK_SLOT;
+}
+
+size_t MaterialBuffer::getUploadCount() const {
+    return buffer.getUploadCount();
+}
+
+size_t MaterialBuffer::getSkippedCount() const {
+    return buffer.getSkippedCount();
+}
@@ -0,0 +1,76 @@
+#ifndef MATERIAL_BUFFER_H
+#define MATERIAL_BUFFER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "UniformBuffer.h"
+
+struct Material;
+
+// Model materials live in one uniform buffer; each draw picks its entry by index
+#define MATERIAL_BUFFER_MAX_MATERIALS 32
+#define MATERIAL_BUFFER_BINDING 2
+
+// Last entry, kept for Material::fallback so materials that don't fit
+// never borrow another material's entry
+#define MATERIAL_BUFFER_FALLBACK_SLOT (MATERIAL_BUFFER_MAX_MATERIALS - 1)
+
+#define MATERIAL_BUFFER_STRINGIFY_(x) #x
+#define MATERIAL_BUFFER_STRINGIFY(x) MATERIAL_BUFFER_STRINGIFY_(x)
+
+// GLSL declaration of the block, spliced into the shader sources. Each
+// vec3 is followed by a float so the std140 layout has no padding.
+#define MATERIAL_BLOCK_GLSL \
+    "#define MAX_MATERIALS " MATERIAL_BUFFER_STRINGIFY(MATERIAL_BUFFER_MAX_MATERIALS) "\n" \
+    "struct Material {\n" \
+    "    vec3 diffuse;\n" \
+    "    float shininess;\n" \
+    "    vec3 specular;\n" \
+    "    float padding;\n" \
+    "};\n" \
+    "layout (std140) uniform Materials {\n" \
+    "    Material materials[MAX_MATERIALS];\n" \
+    "};\n"
+
+// CPU mirror of one element of the block
+struct MaterialData {
+    glm::vec3 diffuse;
+    float shininess;
+    glm::vec3 specular;
+    float padding;
+};
+
+// CPU mirror of the whole block
+struct MaterialBlock {
+    MaterialData materials[MATERIAL_BUFFER_MAX_MATERIALS];
+};
+
+static_assert(sizeof(MaterialData) == 32, "MaterialData must match the std140 Material struct");
+static_assert(sizeof(MaterialBlock) == 32 * MATERIAL_BUFFER_MAX_MATERIALS,
+    "MaterialBlock must match the std140 Materials block");
+
+// Packs a model's materials into the "Materials" block at
+// MATERIAL_BUFFER_BINDING. The materials don't change after loading, so
+// only the first update uploads anything.
+class MaterialBuffer {
+public:
+    MaterialBuffer();
+
+    // Packs the materials and uploads the block if they changed. Materials
+    // from MATERIAL_BUFFER_FALLBACK_SLOT on don't fit; a warning is logged
+    // the first time a model has any.
+    void update(const std::vector<Material>& materials);
+
+    // Block entry for a material index; materials that don't fit use the fallback entry
+    static int slot(unsigned int material);
+
+    // Uploads issued and skipped because the materials were unchanged
+    size_t getUploadCount() const;
+    size_t getSkippedCount() const;
+
+private:
+    UniformBuffer buffer;
+    bool warnedOverflow;
+};
+
+#endif // MATERIAL_BUFFER_H
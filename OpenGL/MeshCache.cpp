@@ -0,0 +1,263 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "MeshCache.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "Model.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = { 'A', 'M', 'S', 'H' };
+
+size_t alignBlob(size_t offset) {
+    return (offset + MeshCache::BLOB_ALIGNMENT - 1) & ~(MeshCache::BLOB_ALIGNMENT - 1);
+}
+
+// Size and modification time of a file, the time in the finest unit the
+// platform keeps so an edit right after the cache was written still shows;
+// false if the file doesn't exist
+bool statFile(const std::string& path, uint64_t& size, int64_t& time) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info)) {
+        return false;
+    }
+    size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    time = (int64_t)(((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    size = (uint64_t)info.st_size;
+#ifdef __APPLE__
+    time = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    time = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+
+// Overwrites the source time in a cache's header; false if it can't be written
+bool writeSourceTime(const std::string& cachePath, int64_t time) {
+    std::fstream out(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+    out.seekp(offsetof(MeshCacheHeader, sourceTime));
+    out.write((const char*)&time, sizeof(time));
+    return (bool)out.flush();
+}
+
+// Whether a blob of count elements at offset lies inside a file of the given size
+bool blobFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+    return offset % MeshCache::BLOB_ALIGNMENT == 0 && offset <= fileSize &&
+        count <= (fileSize - offset) / elementSize;
+}
+
+} // namespace
+
+MeshCache::MeshCache() : header(nullptr) {
+}
+
+bool MeshCache::open(const std::string& cachePath, const std::string& sourcePath) {
+    close();
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!statFile(sourcePath, sourceSize, sourceTime) || !file.open(cachePath)) {
+        return false;
+    }
+
+    const MeshCacheHeader* candidate = (const MeshCacheHeader*)file.getData();
+    uint64_t size = file.getSize();
+    if (size < sizeof(MeshCacheHeader) || std::memcmp(candidate->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        candidate->version != VERSION || candidate->vertexStride != sizeof(Vertex) ||
+        !blobFits(candidate->vertexOffset, candidate->vertexCount, sizeof(Vertex), size) ||
+        !blobFits(candidate->indexOffset, candidate->indexCount, sizeof(unsigned int), size) ||
+        !blobFits(candidate->submeshOffset, candidate->submeshCount, sizeof(Submesh), size) ||
+        !blobFits(candidate->stringOffset, candidate->stringSize, 1, size) ||
+        candidate->sourceSize != sourceSize) {
+        close();
+        return false;
+    }
+
+    // Submeshes must stay inside the index buffer and name a stored
+    // material; the strings are the library and then one name per line
+    const char* strings = file.getData() + candidate->stringOffset;
+    size_t materialCount = (size_t)std::count(strings, strings + candidate->stringSize, '\n');
+    materialCount = materialCount > 0 ? materialCount - 1 : 0;
+    const Submesh* submeshes = (const Submesh*)(file.getData() + candidate->submeshOffset);
+    for (uint32_t i = 0; i < candidate->submeshCount; ++i) {
+        if (submeshes[i].firstIndex > candidate->indexCount ||
+            submeshes[i].indexCount > candidate->indexCount - submeshes[i].firstIndex ||
+            submeshes[i].material >= materialCount) {
+            close();
+            return false;
+        }
+    }
+
+    // A touched but identical source (a fresh checkout, say) keeps its cache.
+    // The new time is written back so later launches skip the hash; the
+    // mapping is closed meanwhile since Windows won't write a mapped file.
+    if (candidate->sourceTime != sourceTime) {
+        MappedFile source;
+        if (!source.open(sourcePath) || hash(source.getData(), source.getSize()) != candidate->sourceHash) {
+            close();
+            return false;
+        }
+        file.close();
+        writeSourceTime(cachePath, sourceTime);
+        if (!file.open(cachePath) || file.getSize() != size) {
+            close();
+            return false;
+        }
+        candidate = (const MeshCacheHeader*)file.getData();
+    }
+
+    header = candidate;
+    return true;
+}
+
+void MeshCache::close() {
+    file.close();
+    header = nullptr;
+}
+
+const Vertex* MeshCache::getVertices() const {
+    return (const Vertex*)(file.getData() + header->vertexOffset);
+}
+
+size_t MeshCache::getVertexCount() const {
+    return header->vertexCount;
+}
+
+const unsigned int* MeshCache::getIndices() const {
+    return (const unsigned int*)(file.getData() + header->indexOffset);
+}
+
+size_t MeshCache::getIndexCount() const {
+    return header->indexCount;
+}
+
+const Submesh* MeshCache::getSubmeshes() const {
+    return (const Submesh*)(file.getData() + header->submeshOffset);
+}
+
+size_t MeshCache::getSubmeshCount() const {
+    return header->submeshCount;
+}
+
+BoundingSphere MeshCache::getBounds() const {
+    BoundingSphere bounds;
+    bounds.center = glm::vec3(header->boundsCenter[0], header->boundsCenter[1], header->boundsCenter[2]);
+    bounds.radius = header->boundsRadius;
+    return bounds;
+}
+
+std::string MeshCache::getMaterialLibrary() const {
+    const char* strings = file.getData() + header->stringOffset;
+    const char* end = (const char*)std::memchr(strings, '\n', header->stringSize);
+    return end ? std::string(strings, end) : std::string();
+}
+
+std::vector<std::string> MeshCache::getMaterialNames() const {
+    std::vector<std::string> names;
+    const char* p = file.getData() + header->stringOffset;
+    const char* end = p + header->stringSize;
+    for (bool library = true; p < end; library = false) {
+        const char* next = (const char*)std::memchr(p, '\n', end - p);
+        next = next ? next : end;
+        if (!library) {
+            names.push_back(std::string(p, next));
+        }
+        p = next + 1;
+    }
+    return names;
+}
+
+bool MeshCache::write(const std::string& cachePath, const std::string& sourcePath,
+    const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    const std::vector<Submesh>& submeshes, const BoundingSphere& bounds, const std::string& materialLibrary,
+    const std::vector<std::string>& materialNames) {
+    MappedFile source;
+    MeshCacheHeader header = {};
+    if (!source.open(sourcePath) || !statFile(sourcePath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.vertexCount = (uint32_t)vertices.size();
+    header.indexCount = (uint32_t)indices.size();
+    header.submeshCount = (uint32_t)submeshes.size();
+    header.sourceHash = hash(source.getData(), source.getSize());
+    header.boundsCenter[0] = bounds.center.x;
+    header.boundsCenter[1] = bounds.center.y;
+    header.boundsCenter[2] = bounds.center.z;
+    header.boundsRadius = bounds.radius;
+    header.vertexOffset = alignBlob(sizeof(MeshCacheHeader));
+    header.indexOffset = alignBlob(header.vertexOffset + vertices.size() * sizeof(Vertex));
+    header.submeshOffset = alignBlob(header.indexOffset + indices.size() * sizeof(unsigned int));
+    std::string strings = materialLibrary + '\n';
+    for (const std::string& name : materialNames) {
+        strings += name + '\n';
+    }
+    header.stringOffset = alignBlob(header.submeshOffset + submeshes.size() * sizeof(Submesh));
+    header.stringSize = strings.size();
+
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        // Zero padding up to each blob's offset
+        const char padding[BLOB_ALIGNMENT] = {};
+        auto writeBlob = [&](uint64_t offset, const void* data, size_t bytes) {
+            out.write(padding, (std::streamsize)(offset - (uint64_t)out.tellp()));
+            out.write((const char*)data, (std::streamsize)bytes);
+        };
+        out.write((const char*)&header, sizeof(header));
+        writeBlob(header.vertexOffset, vertices.data(), vertices.size() * sizeof(Vertex));
+        writeBlob(header.indexOffset, indices.data(), indices.size() * sizeof(unsigned int));
+        writeBlob(header.submeshOffset, submeshes.data(), submeshes.size() * sizeof(Submesh));
+        writeBlob(header.stringOffset, strings.data(), strings.size());
+        if (!out.flush()) {
+            out.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    // rename doesn't replace an existing file everywhere
+    std::remove(cachePath.c_str());
+    if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string MeshCache::pathFor(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+uint64_t MeshCache::hash(const char* data, size_t size) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ (unsigned char)data[i]) * 1099511628211ull;
+    }
+    return h;
+}
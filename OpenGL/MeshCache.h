@@ -0,0 +1,86 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Frustum.h"
+#include "MappedFile.h"
+
+struct Vertex;
+struct Submesh;
+
+// Binary mesh file written next to a model the first time it is parsed.
+// Little-endian; the vertex, index, submesh and string blobs each start on
+// a BLOB_ALIGNMENT boundary so they can be used straight from the mapping.
+// The strings are the material library and then each submesh material's
+// name, every one ended by '\n'.
+struct MeshCacheHeader {
+    char magic[4];          // "AMSH"
+    uint32_t version;
+    uint32_t vertexStride;  // sizeof(Vertex) of the build that wrote it
+    uint32_t vertexCount;
+    uint32_t indexCount;    // 32-bit indices
+    uint32_t submeshCount;
+    uint64_t sourceSize;
+    int64_t sourceTime;     // modification time in the platform's unit
+    uint64_t sourceHash;    // FNV-1a of the source file
+    float boundsCenter[3];
+    float boundsRadius;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t submeshOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+};
+
+static_assert(sizeof(MeshCacheHeader) == 104, "mesh cache header layout changed");
+
+// A mesh cache file mapped read-only; its arrays point into the mapping
+class MeshCache {
+public:
+    static const uint32_t VERSION = 3;
+    static const size_t BLOB_ALIGNMENT = 16;
+
+    MeshCache();
+
+    // Maps the cache at cachePath, returning false unless it has this
+    // build's version and vertex layout, its blobs and submeshes lie inside
+    // the file, and it was written from sourcePath as it is now. A changed
+    // timestamp with an unchanged size falls back to comparing the source
+    // hash; on a match the cache takes the new timestamp.
+    bool open(const std::string& cachePath, const std::string& sourcePath);
+    void close();
+
+    const Vertex* getVertices() const;
+    size_t getVertexCount() const;
+    const unsigned int* getIndices() const;
+    size_t getIndexCount() const;
+    const Submesh* getSubmeshes() const;
+    size_t getSubmeshCount() const;
+    BoundingSphere getBounds() const;
+
+    // Material library the OBJ named, and the names Submesh::material indexes
+    std::string getMaterialLibrary() const;
+    std::vector<std::string> getMaterialNames() const;
+
+    // Writes a cache for sourcePath, through a temporary file so a partial
+    // write never replaces a good cache; false if it can't be written
+    static bool write(const std::string& cachePath, const std::string& sourcePath,
+        const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+        const std::vector<Submesh>& submeshes, const BoundingSphere& bounds, const std::string& materialLibrary,
+        const std::vector<std::string>& materialNames);
+
+    // Where the cache for a source file lives
+    static std::string pathFor(const std::string& sourcePath);
+
+    // 64-bit FNV-1a of a byte range
+    static uint64_t hash(const char* data, size_t size);
+
+private:
+    MappedFile file;
+    const MeshCacheHeader* header;
+};
+
+#endif // MESH_CACHE_H
@@ -0,0 +1,201 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+// Forsyth's scoring constants
+const int CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+const unsigned int VALENCE_TABLE_SIZE = 64;
+
+// Both score terms tabulated once, since every emitted triangle rescores
+// up to CACHE_SIZE + 3 vertices
+struct ScoreTables {
+    float cache[CACHE_SIZE];
+    float valence[VALENCE_TABLE_SIZE];
+
+    ScoreTables() {
+        for (int i = 0; i < CACHE_SIZE; ++i) {
+            const float scale = 1.0f / (CACHE_SIZE - 3);
+            cache[i] = i < 3 ? LAST_TRIANGLE_SCORE : std::pow(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+        }
+        valence[0] = 0.0f;
+        for (unsigned int i = 1; i < VALENCE_TABLE_SIZE; ++i) {
+            valence[i] = VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+        }
+    }
+};
+
+// Vertices used by the last triangle score a fixed amount so the next one
+// doesn't simply reuse the same edge; older entries decay with their age.
+// Vertices with few triangles left get a boost so they are finished off.
+float vertexScore(const ScoreTables& tables, int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    if (remainingTriangles < VALENCE_TABLE_SIZE) {
+        return score + tables.valence[remainingTriangles];
+    }
+    return score + VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+}
+
+} // namespace
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles around each vertex; the first remaining[v] entries of a
+    // vertex's range are the ones not emitted yet
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (unsigned int index : indices) {
+        ++adjacencyOffsets[index + 1];
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = indices[t * 3 + k];
+            adjacency[adjacencyOffsets[v] + remaining[v]++] = (unsigned int)t;
+        }
+    }
+
+    static const ScoreTables tables;
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScores[v] = vertexScore(tables, -1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] +
+            vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    unsigned int cache[CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t nextUnemitted = 0;
+    size_t best = 0;
+    bool haveBest = false;
+
+    while (output.size() < indices.size()) {
+        // Nothing in the cache has triangles left: start over at the first
+        // triangle not drawn yet
+        if (!haveBest) {
+            while (emitted[nextUnemitted]) {
+                ++nextUnemitted;
+            }
+            best = nextUnemitted;
+        }
+
+        const unsigned int* triangle = &indices[best * 3];
+        emitted[best] = 1;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // Drop the triangle from its vertices' remaining lists
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = triangle[k];
+            unsigned int* begin = &adjacency[adjacencyOffsets[v]];
+            unsigned int* last = begin + --remaining[v];
+            std::iter_swap(std::find(begin, last, (unsigned int)best), last);
+        }
+
+        // The triangle's vertices move to the front of the LRU cache
+        unsigned int newCache[CACHE_SIZE + 3];
+        int newCount = 0;
+        for (int k = 0; k < 3; ++k) {
+            newCache[newCount++] = triangle[k];
+        }
+        for (int i = 0; i < cacheCount; ++i) {
+            unsigned int v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // Rescore the vertices whose position changed, including the ones
+        // pushed out, and their remaining triangles
+        for (int i = 0; i < newCount; ++i) {
+            unsigned int v = newCache[i];
+            cachePosition[v] = i < CACHE_SIZE ? i : -1;
+            float score = vertexScore(tables, cachePosition[v], remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            const unsigned int* around = &adjacency[adjacencyOffsets[v]];
+            for (unsigned int j = 0; j < remaining[v]; ++j) {
+                triangleScores[around[j]] += delta;
+            }
+        }
+
+        cacheCount = std::min(newCount, CACHE_SIZE);
+        for (int i = 0; i < cacheCount; ++i) {
+            cache[i] = newCache[i];
+        }
+
+        // Next triangle is the best one touching the cache
+        haveBest = false;
+        float bestScore = 0.0f;
+        for (int i = 0; i < cacheCount; ++i) {
+            unsigned int v = cache[i];
+            const unsigned int* around = &adjacency[adjacencyOffsets[v]];
+            for (unsigned int j = 0; j < remaining[v]; ++j) {
+                if (!haveBest || triangleScores[around[j]] > bestScore) {
+                    best = around[j];
+                    bestScore = triangleScores[best];
+                    haveBest = true;
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int>& indices, size_t vertexCount) {
+    std::vector<unsigned int> remap(vertexCount, UINT_MAX);
+    std::vector<unsigned int> order;
+    order.reserve(vertexCount);
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == UINT_MAX) {
+            remap[index] = (unsigned int)order.size();
+            order.push_back(index);
+        }
+        index = remap[index];
+    }
+    return order;
+}
+
+float averageCacheMissRatio(const std::vector<unsigned int>& indices, size_t cacheSize) {
+    if (indices.size() < 3) {
+        return 0.0f;
+    }
+
+    // Miss count when each vertex last entered the cache, plus one (0 = never)
+    unsigned int maxIndex = *std::max_element(indices.begin(), indices.end());
+    std::vector<size_t> enteredAt(maxIndex + 1, 0);
+    size_t misses = 0;
+    for (unsigned int index : indices) {
+        size_t entered = enteredAt[index];
+        if (entered == 0 || misses >= entered - 1 + cacheSize) {
+            enteredAt[index] = ++misses;
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
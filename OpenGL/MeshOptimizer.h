@@ -0,0 +1,31 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+// Reorders the triangles of an indexed triangle list so consecutive
+// triangles reuse vertices still in the GPU's post-transform cache
+// (Forsyth's linear-speed algorithm, scored against a 32-entry LRU cache)
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+// Renumbers vertices in the order the indices first reference them, so
+// vertex fetches walk the buffer forwards. Rewrites indices and returns,
+// for each new vertex, the old vertex it comes from.
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int>& indices, size_t vertexCount);
+
+// Reorders vertices by the list optimizeVertexFetch returned
+template <typename Vertex>
+void remapVertices(std::vector<Vertex>& vertices, const std::vector<unsigned int>& order) {
+    std::vector<Vertex> remapped(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        remapped[i] = vertices[order[i]];
+    }
+    vertices.swap(remapped);
+}
+
+// Vertices transformed per triangle with a FIFO post-transform cache of
+// cacheSize entries (ACMR); 0.5 is the ideal for a large closed mesh, 3 the worst
+float averageCacheMissRatio(const std::vector<unsigned int>& indices, size_t cacheSize);
+
+#endif // MESH_OPTIMIZER_H
@@ -1,18 +1,27 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include "Model.h"
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 #include "Light.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
 
 // Mesh implementation
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
-    : vertices(vertices), indices(indices) {
-    setupMesh();
+Mesh::Mesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+    const std::vector<Submesh>& submeshes)
+    : indexCount(indexCount), submeshes(submeshes) {
+    setupMesh(vertices, vertexCount, indices);
 }
 
-void Mesh::setupMesh() {
+void Mesh::setupMesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices) {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
@@ -26,10 +35,10 @@ void Mesh::setupMesh() {
 
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
     // Vertex positions
     glEnableVertexAttribArray(0);
@@ -46,12 +55,6 @@ void Mesh::setupMesh() {
     glBindVertexArray(0);
 }
 
-void Mesh::draw(unsigned int shaderProgram) {
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-}
-
 void Mesh::cleanup() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
@@ -59,7 +62,12 @@ void Mesh::cleanup() {
 }
 
 // Model implementation
-Model::Model(const std::string& path) : position(0.0f), rotation(0.0f), scale(1.0f) {
+Model::Model() : bounds{ glm::vec3(0.0f), 0.0f }, position(0.0f), rotation(0.0f), scale(1.0f),
+    useQuaternion(false) {
+}
+
+Model::Model(const std::string& path) : bounds{ glm::vec3(0.0f), 0.0f }, position(0.0f), rotation(0.0f),
+    scale(1.0f), useQuaternion(false) {
     loadModel(path);
 }
 
@@ -70,127 +78,688 @@ Model::~Model() {
 }
 
 void Model::loadModel(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open model file: " << path << std::endl;
+    // The cached buffers go to the GPU straight from the mapping
+    std::string cachePath = MeshCache::pathFor(path);
+    MeshCache cache;
+    if (cache.open(cachePath, path)) {
+        LOG_INFO("Loaded model cache %s: %zu vertices, %zu indices", cachePath.c_str(), cache.getVertexCount(),
+            cache.getIndexCount());
+        bounds = cache.getBounds();
+        meshes.push_back(Mesh(cache.getVertices(), cache.getVertexCount(), cache.getIndices(),
+            cache.getIndexCount(), std::vector<Submesh>(cache.getSubmeshes(),
+                cache.getSubmeshes() + cache.getSubmeshCount())));
+        loadMaterials(path, cache.getMaterialLibrary(), cache.getMaterialNames());
         return;
     }
 
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> texCoords;
     std::vector<Vertex> finalVertices;
     std::vector<unsigned int> indices;
+    ObjMaterials objMaterials;
+    if (!parseObj(path, finalVertices, indices, &objMaterials)) {
+        return;
+    }
+
+    // Create the mesh, each submesh ordered for the post-transform cache and
+    // the whole for vertex fetch
+    if (!finalVertices.empty() && !indices.empty()) {
+        std::vector<unsigned int> submeshIndices;
+        for (const Submesh& submesh : objMaterials.submeshes) {
+            auto first = indices.begin() + submesh.firstIndex;
+            submeshIndices.assign(first, first + submesh.indexCount);
+            optimizeVertexCache(submeshIndices, finalVertices.size());
+            std::copy(submeshIndices.begin(), submeshIndices.end(), first);
+        }
+        remapVertices(finalVertices, optimizeVertexFetch(indices, finalVertices.size()));
+        bounds = computeBounds(finalVertices);
+        meshes.push_back(Mesh(finalVertices.data(), finalVertices.size(), indices.data(), indices.size(),
+            objMaterials.submeshes));
+        loadMaterials(path, objMaterials.library, objMaterials.names);
+
+        if (!MeshCache::write(cachePath, path, finalVertices, indices, objMaterials.submeshes, bounds,
+            objMaterials.library, objMaterials.names)) {
+            LOG_WARN("Warning: Cannot write model cache %s", cachePath.c_str());
+        }
+    }
+    else {
+        LOG_WARN("Warning: No valid mesh data loaded from %s", path.c_str());
+    }
+}
+
+void Model::loadMaterials(const std::string& path, const std::string& library,
+    const std::vector<std::string>& names) {
+    // The library is read on every load, so edits to it don't need a new mesh cache
+    std::vector<Material> libraryMaterials;
+    if (!library.empty()) {
+        size_t slash = path.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+        if (!parseMtl(directory + library, libraryMaterials)) {
+            LOG_WARN("Warning: Cannot read material library %s", (directory + library).c_str());
+        }
+    }
+
+    materials.clear();
+    for (const std::string& name : names) {
+        auto found = std::find_if(libraryMaterials.begin(), libraryMaterials.end(),
+            [&name](const Material& material) { return material.name == name; });
+        materials.push_back(found != libraryMaterials.end() ? *found : Material::fallback(name));
+    }
+}
+
+Material Material::fallback(const std::string& name) {
+    Material material;
+    material.name = name;
+    material.diffuse = glm::vec3(0.15f);
+    material.specular = glm::vec3(0.5f);
+    material.shininess = 64.0f;
+    return material;
+}
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
+namespace {
 
-        if (prefix == "v") {
+// OBJ tokenizer over a character range. Nothing here crosses a '\n', so a
+// line is always finished with skipLine.
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* skipLine(const char* p, const char* end) {
+    const char* newline = (const char*)std::memchr(p, '\n', end - p);
+    return newline ? newline + 1 : end;
+}
+
+// Powers of ten that are exact as floats
+const float EXACT_POWERS_OF_TEN[11] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+// Reads one number after optional blanks; value is 0 when there is none.
+// Plain decimals whose digits fit a float's mantissa (exporters commonly
+// write six decimals) take one exact division, which rounds the same as
+// from_chars; from_chars parses everything else.
+inline const char* parseFloat(const char* p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') {
+        ++p; // from_chars doesn't accept a leading '+'
+    }
+
+    const char* q = p;
+    bool negative = q < end && *q == '-';
+    q += negative ? 1 : 0;
+    uint32_t mantissa = 0;
+    int digits = 0, fractionDigits = 0;
+    for (; q < end && (unsigned)(*q - '0') < 10 && digits < 9; ++q, ++digits) {
+        mantissa = mantissa * 10 + (*q - '0');
+    }
+    if (q < end && *q == '.') {
+        for (++q; q < end && (unsigned)(*q - '0') < 10 && digits < 9; ++q, ++digits, ++fractionDigits) {
+            mantissa = mantissa * 10 + (*q - '0');
+        }
+    }
+    bool plain = digits > 0 && (q == end || ((unsigned)(*q - '0') >= 10 && *q != 'e' && *q != 'E'));
+    if (plain && mantissa <= (1u << 24)) {
+        value = (float)mantissa / EXACT_POWERS_OF_TEN[fractionDigits];
+        value = negative ? -value : value;
+        return q;
+    }
+
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        value = 0.0f;
+        return p;
+    }
+    return result.ptr;
+}
+
+// Reads an unsigned or negative index; value is 0 when there is none
+inline const char* parseIndex(const char* p, const char* end, int& value) {
+    bool negative = p < end && *p == '-';
+    const char* q = p + (negative ? 1 : 0);
+    int digits = 0;
+    unsigned int index = 0;
+    for (; q < end && (unsigned)(*q - '0') < 10 && digits < 9; ++q, ++digits) {
+        index = index * 10 + (*q - '0');
+    }
+    if (digits == 0 || (q < end && (unsigned)(*q - '0') < 10)) {
+        value = 0; // missing or out of range, resolves to nothing
+        return p;
+    }
+    value = negative ? -(int)index : (int)index;
+    return q;
+}
+
+// One face corner, v, v/vt, v//vn or v/vt/vn, as the file writes the indices
+// (1-based, negative counting back from the latest record, 0 if absent)
+struct ObjCorner {
+    int position, texCoord, normal;
+};
+
+inline const char* parseCorner(const char* p, const char* end, ObjCorner& corner) {
+    corner.texCoord = 0;
+    corner.normal = 0;
+    p = parseIndex(p, end, corner.position);
+    if (p < end && *p == '/') {
+        p = parseIndex(p + 1, end, corner.texCoord);
+        if (p < end && *p == '/') {
+            p = parseIndex(p + 1, end, corner.normal);
+        }
+    }
+    // Skip whatever else is in the token
+    while (p < end && !isBlank(*p) && *p != '\n') {
+        ++p;
+    }
+    return p;
+}
+
+// A face corner with its indices checked against the arrays read so far
+// and made 0-based; UINT_MAX where it refers to nothing
+struct CornerKey {
+    unsigned int position, texCoord, normal;
+};
+
+inline uint32_t hashCorner(const CornerKey& key) {
+    uint32_t h = key.position * 0x9E3779B1u;
+    h = (h ^ key.texCoord) * 0x85EBCA77u;
+    h = (h ^ key.normal) * 0xC2B2AE3Du;
+    return h ^ (h >> 16);
+}
+
+// Open-addressing hash table from corner keys to the vertex made for them,
+// so identical v/vt/vn triples become one shared vertex. Slots only hold
+// vertex indices, which keeps the table small; keys are stored per vertex.
+class CornerWelder {
+public:
+    explicit CornerWelder(size_t expectedVertices) {
+        size_t capacity = 16;
+        while (capacity < expectedVertices * 2) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, 0);
+        keys.reserve(expectedVertices);
+    }
+
+    // Vertex for the key; when there is none yet, nextIndex is recorded for
+    // it and inserted is set so the caller appends that vertex
+    unsigned int find(const CornerKey& key, unsigned int nextIndex, bool& inserted) {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hashCorner(key) & mask;; slot = (slot + 1) & mask) {
+            unsigned int entry = slots[slot];
+            if (entry == 0) {
+                slots[slot] = nextIndex + 1;
+                keys.push_back(key);
+                inserted = true;
+                if (keys.size() * 2 > slots.size()) {
+                    grow();
+                }
+                return nextIndex;
+            }
+            const CornerKey& existing = keys[entry - 1];
+            if (existing.position == key.position && existing.texCoord == key.texCoord &&
+                existing.normal == key.normal) {
+                inserted = false;
+                return entry - 1;
+            }
+        }
+    }
+
+    // Keys in the order their vertices were made
+    const std::vector<CornerKey>& getKeys() const {
+        return keys;
+    }
+
+private:
+    // Doubles the table once it is half full
+    void grow() {
+        slots.assign(slots.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            size_t slot = hashCorner(keys[i]) & mask;
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = (unsigned int)i + 1;
+        }
+    }
+
+    std::vector<unsigned int> slots; // vertex index + 1, 0 when empty
+    std::vector<CornerKey> keys;     // by vertex index
+};
+
+// Record type of the line at p (after leading blanks)
+enum ObjLine {
+    OBJ_OTHER, OBJ_POSITION, OBJ_NORMAL, OBJ_TEX_COORD, OBJ_FACE, OBJ_USE_MATERIAL, OBJ_MATERIAL_LIBRARY,
+    OBJ_LINE_TYPES
+};
+
+inline ObjLine lineType(const char* p, const char* end) {
+    if (end - p >= 2 && isBlank(p[1])) {
+        return p[0] == 'v' ? OBJ_POSITION : p[0] == 'f' ? OBJ_FACE : OBJ_OTHER;
+    }
+    if (end - p >= 3 && p[0] == 'v' && isBlank(p[2])) {
+        return p[1] == 'n' ? OBJ_NORMAL : p[1] == 't' ? OBJ_TEX_COORD : OBJ_OTHER;
+    }
+    if (end - p >= 7 && (p[0] == 'u' || p[0] == 'm') && isBlank(p[6])) {
+        return std::memcmp(p, "usemtl", 6) == 0 ? OBJ_USE_MATERIAL :
+            std::memcmp(p, "mtllib", 6) == 0 ? OBJ_MATERIAL_LIBRARY : OBJ_OTHER;
+    }
+    return OBJ_OTHER;
+}
+
+// Rest of the line after blanks, without trailing blanks
+std::string readName(const char* p, const char* end) {
+    p = skipBlanks(p, end);
+    const char* last = p;
+    while (last < end && *last != '\n') {
+        ++last;
+    }
+    while (last > p && isBlank(last[-1])) {
+        --last;
+    }
+    return std::string(p, last);
+}
+
+// A usemtl record: faces from firstTriangle on use the named material
+struct ObjMaterialRun {
+    size_t firstTriangle;
+    std::string name;
+};
+
+// 0-based index for an OBJ reference when `defined` records of its type
+// precede it: positive ones count from the start of the file, negative
+// ones back from the latest record. UINT_MAX when it refers to nothing.
+inline unsigned int resolveIndex(int index, size_t defined) {
+    if (index > 0 && (size_t)index <= defined) {
+        return (unsigned int)(index - 1);
+    }
+    if (index < 0 && (size_t)-(long long)index <= defined) {
+        return (unsigned int)(defined - (size_t)-(long long)index);
+    }
+    return UINT_MAX;
+}
+
+// Line-aligned slice of an OBJ file, parsed on its own. Its positions,
+// normals and texture coordinates go straight into the file-wide arrays;
+// its faces are welded into corners local to the slice.
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    size_t counts[OBJ_LINE_TYPES];   // records in the chunk
+    size_t firstRecord[OBJ_LINE_TYPES]; // records of each type before it
+    std::vector<CornerKey> corners;  // distinct corners, in first-use order
+    std::vector<unsigned int> indices; // triangles over corners
+    size_t cornerCount;              // face corners before welding
+    std::vector<ObjMaterialRun> materialRuns; // triangles counted within the chunk
+    std::string library;             // first mtllib in the chunk
+};
+
+void countChunk(ObjChunk& chunk) {
+    std::fill(chunk.counts, chunk.counts + OBJ_LINE_TYPES, 0);
+    for (const char* p = chunk.begin; p < chunk.end; p = skipLine(p, chunk.end)) {
+        const char* line = skipBlanks(p, chunk.end);
+        ++chunk.counts[lineType(line, chunk.end)];
+    }
+}
+
+void parseChunk(ObjChunk& chunk, glm::vec3* vertices, glm::vec3* normals, glm::vec2* texCoords) {
+    const char* end = chunk.end;
+    size_t vertexCount = chunk.firstRecord[OBJ_POSITION];
+    size_t normalCount = chunk.firstRecord[OBJ_NORMAL];
+    size_t texCoordCount = chunk.firstRecord[OBJ_TEX_COORD];
+
+    // Welding table sized for about one vertex per position or face; it
+    // grows past that
+    CornerWelder welder(std::max(chunk.counts[OBJ_POSITION], chunk.counts[OBJ_FACE]));
+    std::vector<ObjCorner> faceCorners;
+    std::vector<unsigned int> faceVertices;
+    chunk.indices.clear();
+    chunk.indices.reserve(chunk.counts[OBJ_FACE] * 3);
+    chunk.cornerCount = 0;
+    chunk.materialRuns.clear();
+    chunk.library.clear();
+
+    for (const char* p = chunk.begin; p < end; p = skipLine(p, end)) {
+        const char* line = skipBlanks(p, end);
+        switch (lineType(line, end)) {
+        case OBJ_POSITION: {
             // Vertex position
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            vertices.push_back(vertex);
+            glm::vec3& vertex = vertices[vertexCount++];
+            line = parseFloat(line + 1, end, vertex.x);
+            line = parseFloat(line, end, vertex.y);
+            parseFloat(line, end, vertex.z);
+            break;
         }
-        else if (prefix == "vn") {
+        case OBJ_NORMAL: {
             // Vertex normal
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            normals.push_back(normal);
+            glm::vec3& normal = normals[normalCount++];
+            line = parseFloat(line + 2, end, normal.x);
+            line = parseFloat(line, end, normal.y);
+            parseFloat(line, end, normal.z);
+            break;
         }
-        else if (prefix == "vt") {
+        case OBJ_TEX_COORD: {
             // Texture coordinate
-            glm::vec2 texCoord;
-            iss >> texCoord.x >> texCoord.y;
-            texCoords.push_back(texCoord);
-        }
-        else if (prefix == "f") {
-            // Face - parse indices properly
-            std::string vertex1, vertex2, vertex3;
-            iss >> vertex1 >> vertex2 >> vertex3;
-
-            // Parse each vertex of the face
-            for (const std::string& vertexData : { vertex1, vertex2, vertex3 }) {
-                Vertex vertex;
-                std::istringstream viss(vertexData);
-                std::string indexStr;
-
-                // Parse vertex index (v/vt/vn format)
-                std::getline(viss, indexStr, '/');
-                int vIndex = std::stoi(indexStr) - 1; // OBJ is 1-indexed
-                if (vIndex >= 0 && vIndex < vertices.size()) {
-                    vertex.position = vertices[vIndex];
-                }
-                else {
-                    vertex.position = glm::vec3(0.0f);
+            glm::vec2& texCoord = texCoords[texCoordCount++];
+            line = parseFloat(line + 2, end, texCoord.x);
+            parseFloat(line, end, texCoord.y);
+            break;
+        }
+        case OBJ_FACE: {
+            // Face: every corner (v/vt/vn, OBJ is 1-indexed), fanned into
+            // triangles around the first one
+            faceCorners.clear();
+            line += 1;
+            while (true) {
+                line = skipBlanks(line, end);
+                if (line == end || *line == '\n') {
+                    break;
                 }
+                ObjCorner corner;
+                line = parseCorner(line, end, corner);
+                faceCorners.push_back(corner);
+            }
+            if (faceCorners.size() < 3) {
+                break;
+            }
 
-                // Parse texture coordinate index
-                if (std::getline(viss, indexStr, '/') && !indexStr.empty()) {
-                    int vtIndex = std::stoi(indexStr) - 1;
-                    if (vtIndex >= 0 && vtIndex < texCoords.size()) {
-                        vertex.texCoords = texCoords[vtIndex];
-                    }
-                    else {
-                        vertex.texCoords = glm::vec2(0.0f);
-                    }
-                }
-                else {
-                    vertex.texCoords = glm::vec2(0.0f);
-                }
+            // Corners with the same position, texture coordinate and normal
+            // share one vertex
+            faceVertices.clear();
+            for (const ObjCorner& corner : faceCorners) {
+                CornerKey key = {
+                    resolveIndex(corner.position, vertexCount),
+                    resolveIndex(corner.texCoord, texCoordCount),
+                    resolveIndex(corner.normal, normalCount)
+                };
+                bool inserted;
+                faceVertices.push_back(welder.find(key, (unsigned int)welder.getKeys().size(), inserted));
+            }
 
-                // Parse normal index
-                if (std::getline(viss, indexStr) && !indexStr.empty()) {
-                    int vnIndex = std::stoi(indexStr) - 1;
-                    if (vnIndex >= 0 && vnIndex < normals.size()) {
-                        vertex.normal = normals[vnIndex];
-                    }
-                    else {
-                        vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
-                    }
+            for (size_t k = 2; k < faceVertices.size(); ++k) {
+                chunk.indices.push_back(faceVertices[0]);
+                chunk.indices.push_back(faceVertices[k - 1]);
+                chunk.indices.push_back(faceVertices[k]);
+            }
+            chunk.cornerCount += faceVertices.size();
+            break;
+        }
+        case OBJ_USE_MATERIAL: {
+            // Faces from here on use this material
+            ObjMaterialRun run = { chunk.indices.size() / 3, readName(line + 6, end) };
+            chunk.materialRuns.push_back(run);
+            break;
+        }
+        case OBJ_MATERIAL_LIBRARY:
+            if (chunk.library.empty()) {
+                chunk.library = readName(line + 6, end);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    chunk.corners = welder.getKeys();
+}
+
+// Welds corners that repeat across chunks and renumbers each chunk's
+// indices to the merged vertices, whose keys are returned in the order of
+// their first use in the file. Corners are split between the pool's threads
+// by hash, so each thread owns a disjoint part of the welding table.
+void mergeChunks(std::vector<ObjChunk>& chunks, ThreadPool& pool, std::vector<CornerKey>& keys) {
+    const size_t chunkCount = chunks.size();
+    std::vector<size_t> firstCorner(chunkCount + 1, 0);
+    for (size_t i = 0; i < chunkCount; ++i) {
+        firstCorner[i + 1] = firstCorner[i] + chunks[i].corners.size();
+    }
+
+    // For each chunk corner, the file-wide number of the first corner equal to it
+    std::vector<unsigned int> firstUse(firstCorner.back());
+    pool.run(chunkCount, [&](size_t partition) {
+        CornerWelder welder(firstCorner.back() / chunkCount);
+        std::vector<unsigned int> welded; // first use of each welded vertex
+        for (size_t i = 0; i < chunkCount; ++i) {
+            const std::vector<CornerKey>& corners = chunks[i].corners;
+            for (size_t c = 0; c < corners.size(); ++c) {
+                if (((uint64_t)hashCorner(corners[c]) * chunkCount >> 32) != partition) {
+                    continue;
                 }
-                else {
-                    vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+                bool inserted;
+                unsigned int vertex = welder.find(corners[c], (unsigned int)welded.size(), inserted);
+                if (inserted) {
+                    welded.push_back((unsigned int)(firstCorner[i] + c));
                 }
+                firstUse[firstCorner[i] + c] = welded[vertex];
+            }
+        }
+    });
 
-                finalVertices.push_back(vertex);
-                indices.push_back(finalVertices.size() - 1);
+    // Number the first uses in file order: count per chunk, then assign
+    std::vector<size_t> firstVertex(chunkCount + 1, 0);
+    pool.run(chunkCount, [&](size_t i) {
+        for (size_t id = firstCorner[i]; id < firstCorner[i + 1]; ++id) {
+            firstVertex[i + 1] += firstUse[id] == id ? 1 : 0;
+        }
+    });
+    for (size_t i = 0; i < chunkCount; ++i) {
+        firstVertex[i + 1] += firstVertex[i];
+    }
+
+    keys.resize(firstVertex.back());
+    std::vector<unsigned int> vertexOf(firstCorner.back()); // set for first uses only
+    pool.run(chunkCount, [&](size_t i) {
+        size_t vertex = firstVertex[i];
+        for (size_t c = 0; c < chunks[i].corners.size(); ++c) {
+            size_t id = firstCorner[i] + c;
+            if (firstUse[id] == id) {
+                keys[vertex] = chunks[i].corners[c];
+                vertexOf[id] = (unsigned int)vertex++;
             }
         }
+    });
+    pool.run(chunkCount, [&](size_t i) {
+        for (unsigned int& index : chunks[i].indices) {
+            index = vertexOf[firstUse[firstCorner[i] + index]];
+        }
+    });
+}
+
+// Below this many bytes per chunk, starting threads costs more than it saves
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+} // namespace
+
+bool Model::parseObj(const std::string& path, std::vector<Vertex>& finalVertices,
+    std::vector<unsigned int>& indices, ObjMaterials* materials) {
+    MappedFile file;
+    if (!file.open(path)) {
+        LOG_ERROR("Failed to open model file: %s", path.c_str());
+        return false;
     }
+    return parseObjData(file.getData(), file.getSize(), finalVertices, indices, 0, materials);
+}
 
-    file.close();
+bool Model::parseObjData(const char* data, size_t size, std::vector<Vertex>& finalVertices,
+    std::vector<unsigned int>& indices, unsigned int chunkCount, ObjMaterials* materials) {
+    const char* end = data + size;
+    ThreadPool& pool = ThreadPool::shared();
+    if (chunkCount == 0) {
+        chunkCount = (unsigned int)std::min<size_t>(pool.getThreadCount(), size / MIN_CHUNK_SIZE);
+    }
+    chunkCount = std::max(chunkCount, 1u);
+
+    // Split at line starts so no record straddles two chunks
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* chunkBegin = data;
+    for (unsigned int i = 0; i < chunkCount; ++i) {
+        const char* chunkEnd = i + 1 < chunkCount ? data + size / chunkCount * (i + 1) : end;
+        if (chunkEnd > chunkBegin && chunkEnd < end) {
+            chunkEnd = skipLine(chunkEnd - 1, end);
+        }
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = std::max(chunkBegin, chunkEnd);
+        chunkBegin = chunks[i].end;
+    }
 
-    std::cout << "Loaded model with:" << std::endl;
-    std::cout << "  Original vertices: " << vertices.size() << std::endl;
-    std::cout << "  Original normals: " << normals.size() << std::endl;
-    std::cout << "  Original texture coords: " << texCoords.size() << std::endl;
-    std::cout << "  Final vertices: " << finalVertices.size() << std::endl;
-    std::cout << "  Indices: " << indices.size() << std::endl;
+    // Count the records first so every array is allocated once and each
+    // chunk knows where its records land
+    pool.run(chunks.size(), [&](size_t i) { countChunk(chunks[i]); });
+    size_t counts[OBJ_LINE_TYPES] = {};
+    for (ObjChunk& chunk : chunks) {
+        for (int type = 0; type < OBJ_LINE_TYPES; ++type) {
+            chunk.firstRecord[type] = counts[type];
+            counts[type] += chunk.counts[type];
+        }
+    }
 
-    // Create the mesh
-    if (!finalVertices.empty() && !indices.empty()) {
-        meshes.push_back(Mesh(finalVertices, indices));
+    std::vector<glm::vec3> vertices(counts[OBJ_POSITION]);
+    std::vector<glm::vec3> normals(counts[OBJ_NORMAL]);
+    std::vector<glm::vec2> texCoords(counts[OBJ_TEX_COORD]);
+    pool.run(chunks.size(), [&](size_t i) {
+        parseChunk(chunks[i], vertices.data(), normals.data(), texCoords.data());
+    });
+
+    // Merge: corners that repeat across chunks become one vertex
+    std::vector<CornerKey> keys;
+    if (chunks.size() > 1) {
+        mergeChunks(chunks, pool, keys);
     }
     else {
-        std::cerr << "Warning: No valid mesh data loaded from " << path << std::endl;
+        keys.swap(chunks[0].corners);
     }
-}
 
-void Model::draw(unsigned int shaderProgram, const glm::mat4& view, const glm::mat4& projection) {
-    glUseProgram(shaderProgram);
+    std::vector<size_t> firstIndex(chunks.size() + 1, 0);
+    size_t cornerCount = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        firstIndex[i + 1] = firstIndex[i] + chunks[i].indices.size();
+        cornerCount += chunks[i].cornerCount;
+    }
 
-    // Set matrices
-    glm::mat4 model = getModelMatrix();
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    finalVertices.resize(keys.size());
+    indices.resize(firstIndex.back());
+    pool.run(chunks.size(), [&](size_t i) {
+        // Vertices for the welded corners, in equal slices
+        size_t vertexBegin = keys.size() * i / chunks.size();
+        size_t vertexEnd = keys.size() * (i + 1) / chunks.size();
+        for (size_t v = vertexBegin; v < vertexEnd; ++v) {
+            const CornerKey& key = keys[v];
+            Vertex& vertex = finalVertices[v];
+            vertex.position = key.position != UINT_MAX ? vertices[key.position] : glm::vec3(0.0f);
+            vertex.texCoords = key.texCoord != UINT_MAX ? texCoords[key.texCoord] : glm::vec2(0.0f);
+            vertex.normal = key.normal != UINT_MAX ? normals[key.normal] : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
 
-    // Draw all meshes
-    for (auto& mesh : meshes) {
-        mesh.draw(shaderProgram);
+        std::copy(chunks[i].indices.begin(), chunks[i].indices.end(), indices.begin() + firstIndex[i]);
+    });
+
+    // Group the triangles by material, in order of first use
+    std::vector<ObjMaterialRun> runs(1, ObjMaterialRun{ 0, std::string() });
+    std::string library;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        for (ObjMaterialRun& run : chunks[i].materialRuns) {
+            run.firstTriangle += firstIndex[i] / 3;
+            runs.push_back(run);
+        }
+        if (library.empty()) {
+            library = chunks[i].library;
+        }
+    }
+    std::vector<std::string> names;
+    std::vector<size_t> runMaterial(runs.size(), SIZE_MAX);
+    std::vector<size_t> materialIndices;
+    size_t usedRuns = 0;
+    for (size_t r = 0; r < runs.size(); ++r) {
+        size_t runEnd = r + 1 < runs.size() ? runs[r + 1].firstTriangle : indices.size() / 3;
+        if (runEnd == runs[r].firstTriangle) {
+            continue;
+        }
+        size_t material = std::find(names.begin(), names.end(), runs[r].name) - names.begin();
+        if (material == names.size()) {
+            names.push_back(runs[r].name);
+            materialIndices.push_back(0);
+        }
+        runMaterial[r] = material;
+        materialIndices[material] += (runEnd - runs[r].firstTriangle) * 3;
+        ++usedRuns;
+    }
+
+    std::vector<Submesh> submeshes(names.size());
+    for (size_t m = 0, first = 0; m < names.size(); first += materialIndices[m], ++m) {
+        submeshes[m] = Submesh{ (unsigned int)first, (unsigned int)materialIndices[m], (unsigned int)m };
+    }
+
+    // Materials that come back after another one has been used need their
+    // triangles moved together
+    if (usedRuns > names.size()) {
+        std::vector<unsigned int> grouped(indices.size());
+        std::vector<size_t> cursor(names.size());
+        for (size_t m = 0; m < names.size(); ++m) {
+            cursor[m] = submeshes[m].firstIndex;
+        }
+        for (size_t r = 0; r < runs.size(); ++r) {
+            if (runMaterial[r] == SIZE_MAX) {
+                continue;
+            }
+            size_t runEnd = r + 1 < runs.size() ? runs[r + 1].firstTriangle : indices.size() / 3;
+            auto first = indices.begin() + runs[r].firstTriangle * 3;
+            std::copy(first, indices.begin() + runEnd * 3, grouped.begin() + cursor[runMaterial[r]]);
+            cursor[runMaterial[r]] += (runEnd - runs[r].firstTriangle) * 3;
+        }
+        indices.swap(grouped);
+    }
+    if (materials) {
+        materials->library = library;
+        materials->names = names;
+        materials->submeshes = submeshes;
+    }
+
+    LOG_INFO("Loaded model with:");
+    LOG_INFO("  Original vertices: %zu", vertices.size());
+    LOG_INFO("  Original normals: %zu", normals.size());
+    LOG_INFO("  Original texture coords: %zu", texCoords.size());
+    LOG_INFO("  Face corners: %zu", cornerCount);
+    LOG_INFO("  Final vertices: %zu (%.1f%% fewer than corners)", finalVertices.size(),
+        cornerCount ? 100.0 * (1.0 - (double)finalVertices.size() / cornerCount) : 0.0);
+    LOG_INFO("  Indices: %zu", indices.size());
+    LOG_INFO("  Materials: %zu", names.size());
+    LOG_INFO("  Chunks: %zu", chunks.size());
+
+    return true;
+}
+
+bool Model::parseMtl(const std::string& path, std::vector<Material>& materials) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    parseMtlData(file.getData(), file.getSize(), materials);
+    return true;
+}
+
+void Model::parseMtlData(const char* data, size_t size, std::vector<Material>& materials) {
+    const char* end = data + size;
+    materials.clear();
+    for (const char* p = data; p < end; p = skipLine(p, end)) {
+        const char* line = skipBlanks(p, end);
+        if (end - line >= 7 && std::memcmp(line, "newmtl", 6) == 0 && isBlank(line[6])) {
+            // Fields the material leaves out keep the fallback's values
+            materials.push_back(Material::fallback(readName(line + 6, end)));
+        }
+        else if (materials.empty() || end - line < 3 || !isBlank(line[2])) {
+            continue;
+        }
+        else if (line[0] == 'K' && (line[1] == 'd' || line[1] == 's')) {
+            glm::vec3& color = line[1] == 'd' ? materials.back().diffuse : materials.back().specular;
+            line = parseFloat(line + 2, end, color.r);
+            line = parseFloat(line, end, color.g);
+            parseFloat(line, end, color.b);
+        }
+        else if (line[0] == 'N' && line[1] == 's') {
+            parseFloat(line + 2, end, materials.back().shininess);
+        }
     }
 }
 
@@ -201,26 +770,47 @@ glm::mat4 Model::getModelMatrix() const {
 
    
     model = glm::translate(model, position);
+    model = model * glm::mat4_cast(getOrientation());
+    model = glm::scale(model, scale);
 
-    // Use quaternion rotation if available, otherwise fall back to Euler
-    if (useQuaternion) {
-        glm::mat4 rotMatrix = glm::mat4_cast(rotationQuat);
-        model = model * rotMatrix;
+    return model;
+}
+
+BoundingSphere Model::computeBounds(const std::vector<Vertex>& vertices) {
+    BoundingSphere result = { glm::vec3(0.0f), 0.0f };
+    if (vertices.empty()) {
+        return result;
     }
-    else {
-        // Original Euler rotation (keep as fallback)
-        glm::quat qPitch = glm::angleAxis(glm::radians(rotation.x), glm::vec3(0, 0, 1));
-        glm::quat qYaw = glm::angleAxis(glm::radians(rotation.y), glm::vec3(0, 1, 0));
-        glm::quat qRoll = glm::angleAxis(glm::radians(rotation.z), glm::vec3(1, 0, 0));
 
-        glm::quat q = qYaw * qPitch * qRoll;
-        glm::mat4 rotMatrix = glm::mat4_cast(q);
-        model = model * rotMatrix;
+    glm::vec3 boundsMin = vertices[0].position;
+    glm::vec3 boundsMax = vertices[0].position;
+    for (const Vertex& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
     }
+    result.center = (boundsMin + boundsMax) * 0.5f;
 
-    model = glm::scale(model, scale);
+    float radiusSquared = 0.0f;
+    for (const Vertex& vertex : vertices) {
+        glm::vec3 offset = vertex.position - result.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    result.radius = std::sqrt(radiusSquared);
+    return result;
+}
 
-    return model;
+glm::quat Model::getOrientation() const {
+    // Use quaternion rotation if available, otherwise fall back to Euler
+    if (useQuaternion) {
+        return rotationQuat;
+    }
+
+    // Original Euler rotation (keep as fallback)
+    glm::quat qPitch = glm::angleAxis(glm::radians(rotation.x), glm::vec3(0, 0, 1));
+    glm::quat qYaw = glm::angleAxis(glm::radians(rotation.y), glm::vec3(0, 1, 0));
+    glm::quat qRoll = glm::angleAxis(glm::radians(rotation.z), glm::vec3(1, 0, 0));
+
+    return qYaw * qPitch * qRoll;
 }
 
 void Model::setRotationFromQuaternion(const glm::quat& quat) {
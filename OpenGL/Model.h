@@ -6,6 +6,8 @@
 #include <glm/gtx/quaternion.hpp>
 #include <vector>
 #include <string>
+#include "ShaderProgram.h"
+#include "Frustum.h"
 
 
 struct Vertex {
@@ -14,23 +16,53 @@ struct Vertex {
     glm::vec2 texCoords;
 };
 
+// Surface parameters from an MTL file
+struct Material {
+    std::string name;
+    glm::vec3 diffuse;  // Kd
+    glm::vec3 specular; // Ks
+    float shininess;    // Ns
+
+    // Dark gunmetal, used where a material is missing from the library
+    static Material fallback(const std::string& name);
+};
+
+// Triangles drawn with one material: a range of a mesh's index buffer
+struct Submesh {
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    unsigned int material;
+};
+
+// Material use found while parsing an OBJ file
+struct ObjMaterials {
+    std::string library;            // first mtllib, relative to the OBJ file
+    std::vector<std::string> names; // usemtl names in order of first use; "" for faces before any
+    std::vector<Submesh> submeshes; // one per name, in the same order
+};
+
+// GPU copy of an indexed triangle list; the data it was built from isn't
+// kept. Its submeshes share the one vertex and index buffer and are drawn
+// through the render queue (see submitGunModel).
 class Mesh {
 public:
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
     unsigned int VAO, VBO, EBO;
+    size_t indexCount;
+    std::vector<Submesh> submeshes;
 
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
-    void draw(unsigned int shaderProgram);
+    Mesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+        const std::vector<Submesh>& submeshes);
     void cleanup();
 
 private:
-    void setupMesh();
+    void setupMesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices);
 };
 
 class Model {
 private:
     std::vector<Mesh> meshes;
+    std::vector<Material> materials; // indexed by Submesh::material
+    BoundingSphere bounds; // model space, computed by loadModel
     glm::vec3 position;
     glm::vec3 rotation;    // Euler angles (degrees) - kept for compatibility
     glm::vec3 scale;
@@ -40,11 +72,10 @@ private:
     bool useQuaternion;
 
 public:
+    Model();
     Model(const std::string& path);
     ~Model();
 
-    void draw(unsigned int shaderProgram, const glm::mat4& view, const glm::mat4& projection);
-
     // Transform setters/getters
     void setPosition(const glm::vec3& pos) { position = pos; }
     void setRotation(const glm::vec3& rot) { rotation = rot; useQuaternion = false; }
@@ -61,8 +92,46 @@ public:
     glm::vec3 getScale() const { return scale; }
     glm::quat getRotationQuaternion() const { return rotationQuat; }
 
+    const std::vector<Mesh>& getMeshes() const { return meshes; }
+    const std::vector<Material>& getMaterials() const { return materials; }
+
+    // Sphere around every vertex in model space (zero radius when nothing loaded)
+    const BoundingSphere& getBounds() const { return bounds; }
+
+    glm::mat4 getModelMatrix() const;
+
+    // Rotation as a quaternion, built from the Euler angles unless quaternion rotation is enabled
+    glm::quat getOrientation() const;
+
+    // Parses an OBJ file into an indexed triangle list without touching
+    // OpenGL. The file is memory-mapped and tokenized in place; polygons are
+    // fanned into triangles and corners with the same v/vt/vn share a vertex.
+    // Triangles are grouped by material, each group in file order; materials
+    // receives the groups and the library named by the file.
+    static bool parseObj(const std::string& path, std::vector<Vertex>& finalVertices,
+        std::vector<unsigned int>& indices, ObjMaterials* materials = nullptr);
+
+    // Same for OBJ text already in memory. Large files are split into
+    // chunkCount line-aligned chunks parsed on the shared thread pool and
+    // merged; 0 picks one chunk per thread, with at least 1 MB each. The
+    // result doesn't depend on the chunk count.
+    static bool parseObjData(const char* data, size_t size, std::vector<Vertex>& finalVertices,
+        std::vector<unsigned int>& indices, unsigned int chunkCount = 0, ObjMaterials* materials = nullptr);
+
+    // Reads the newmtl, Kd, Ks and Ns records of an MTL file
+    static bool parseMtl(const std::string& path, std::vector<Material>& materials);
+
+    // Same for MTL text already in memory
+    static void parseMtlData(const char* data, size_t size, std::vector<Material>& materials);
+
+    // Sphere centered on the vertices' bounding box that encloses all of them
+    static BoundingSphere computeBounds(const std::vector<Vertex>& vertices);
 
 private:
+    // Loads the binary cache next to the file when it is current, otherwise
+    // parses the OBJ and writes the cache for the next launch
     void loadModel(const std::string& path);
-    glm::mat4 getModelMatrix() const;
+
+    // Fills materials from the model's MTL library, one per name
+    void loadMaterials(const std::string& path, const std::string& library, const std::vector<std::string>& names);
 };
\ No newline at end of file
@@ -1,6 +1,9 @@
 #ifndef MODEL_SHADER_H
 #define MODEL_SHADER_H
 
+#include "CameraBuffer.h"
+#include "LightBuffer.h"
+#include "MaterialBuffer.h"
 
 const char* modelVertexShaderSource = R"(
 #version 330 core
@@ -8,22 +11,24 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
+// Per-instance matrices from TransformSystem's instance buffer (TRANSFORM_*_ATTRIB)
+layout (location = 3) in mat4 model;
+layout (location = 7) in mat4 mvp;           // viewProj * model, computed on the CPU
+layout (location = 11) in mat3 normalMatrix; // inverse transpose of model, computed on the CPU
+
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+)" CAMERA_BLOCK_GLSL R"(
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
     
     // **CRITICAL: Proper normal transformation**
-    Normal = normalize(mat3(transpose(inverse(model))) * aNormal);
+    Normal = normalize(normalMatrix * aNormal);
     TexCoord = aTexCoord;
     
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    gl_Position = mvp * vec4(aPos, 1.0);
 }
 )";
 
@@ -35,19 +40,8 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 
-struct Light {
-    vec3 position;
-    vec3 color;
-    float ambient;
-    float diffuse;
-    float specular;
-};
-
-uniform Light lights[4];
-uniform int numLights;
-uniform vec3 viewPos;
-uniform vec3 objectColor;
-uniform float shininess;
+)" CAMERA_BLOCK_GLSL LIGHT_BLOCK_GLSL MATERIAL_BLOCK_GLSL R"(
+uniform int materialIndex; // entry of the Materials block this draw uses
 uniform int hasTexture;
 uniform sampler2D texture_diffuse1;
 
@@ -55,11 +49,12 @@ void main() {
     // **CRITICAL: Normalize the interpolated normal**
     vec3 norm = normalize(Normal);
     vec3 result = vec3(0.0);
+    Material material = materials[materialIndex];
     
     // Enhanced lighting calculation
-    for(int i = 0; i < numLights; i++) {
+    for(int i = 0; i < numLights && i < MAX_LIGHTS; i++) {
         vec3 lightDir = normalize(lights[i].position - FragPos);
-        vec3 viewDir = normalize(viewPos - FragPos);
+        vec3 viewDir = normalize(cameraPos - FragPos);
         
         // Ambient
         vec3 ambient = lights[i].ambient * lights[i].color * 0.3;
@@ -70,8 +65,8 @@ void main() {
         
         // Specular with Blinn-Phong for smoother highlights
         vec3 halfwayDir = normalize(lightDir + viewDir);
-        float spec = pow(max(dot(norm, halfwayDir), 0.0), shininess);
-        vec3 specular = lights[i].specular * spec * lights[i].color * 0.5;
+        float spec = pow(max(dot(norm, halfwayDir), 0.0), material.shininess);
+        vec3 specular = lights[i].specular * spec * lights[i].color * material.specular;
         
         result += (ambient + diffuse + specular);
     }
@@ -79,7 +74,7 @@ void main() {
     // **IMPORTANT: Clamp the result to prevent over-brightness**
     result = clamp(result, 0.0, 1.0);
     
-    vec3 finalColor = result * objectColor;
+    vec3 finalColor = result * material.diffuse;
     FragColor = vec4(finalColor, 1.0);
 }
 )";
@@ -0,0 +1,78 @@
+#include "RenderQueue.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+DrawCommand::DrawCommand()
+    : key(0), program(0), vertexArray(0), textureTarget(GL_TEXTURE_2D), texture(0),
+    depthTest(true), depthFunc(GL_LESS), lineWidth(1.0f),
+    mode(GL_TRIANGLES), count(0), firstIndex(0), indexType(GL_UNSIGNED_INT), instanceCount(0), indexed(true) {
+}
+
+uint64_t RenderQueue::makeKey(RenderPass pass, unsigned int program, unsigned int vertexArray,
+    unsigned int material, float depth) {
+    const uint64_t depthMax = (1u << 24) - 1;
+    float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+    uint64_t depthBits = (uint64_t)(clamped * depthMax);
+    if (pass == PASS_TRANSPARENT) {
+        depthBits = depthMax - depthBits;
+    }
+    return ((uint64_t)(pass & 0xF) << 60) |
+        ((uint64_t)(program & 0xFFF) << 48) |
+        ((uint64_t)(vertexArray & 0xFFF) << 36) |
+        ((uint64_t)(material & 0xFFF) << 24) |
+        depthBits;
+}
+
+void RenderQueue::submit(const DrawCommand& command) {
+    commands.push_back(command);
+}
+
+void RenderQueue::clear() {
+    commands.clear();
+}
+
+size_t RenderQueue::size() const {
+    return commands.size();
+}
+
+void RenderQueue::execute(GLStateCache& state) {
+    order.resize(commands.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = (uint32_t)i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return commands[a].key < commands[b].key;
+    });
+
+    for (uint32_t index : order) {
+        const DrawCommand& command = commands[index];
+
+        state.setEnabled(GL_DEPTH_TEST, command.depthTest);
+        state.depthFunc(command.depthFunc);
+        if (command.mode == GL_LINES || command.mode == GL_LINE_STRIP || command.mode == GL_LINE_LOOP) {
+            state.lineWidth(command.lineWidth);
+        }
+        state.useProgram(command.program);
+        if (command.setup) {
+            command.setup();
+        }
+        state.bindVertexArray(command.vertexArray);
+        if (command.texture != 0) {
+            state.bindTexture(0, command.textureTarget, command.texture);
+        }
+
+        if (!command.indexed) {
+            glDrawArrays(command.mode, 0, command.count);
+            continue;
+        }
+
+        size_t indexSize = command.indexType == GL_UNSIGNED_SHORT ? 2 : command.indexType == GL_UNSIGNED_BYTE ? 1 : 4;
+        const void* offset = (const void*)(command.firstIndex * indexSize);
+        if (command.instanceCount > 0) {
+            glDrawElementsInstanced(command.mode, command.count, command.indexType, offset, command.instanceCount);
+        }
+        else {
+            glDrawElements(command.mode, command.count, command.indexType, offset);
+        }
+    }
+}
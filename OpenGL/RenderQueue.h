@@ -0,0 +1,68 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "GLStateCache.h"
+
+// Passes in the order they are drawn. PASS_SKY runs after the opaque
+// geometry so far-plane draws only shade pixels nothing else covered.
+enum RenderPass {
+    PASS_BACKGROUND = 0,
+    PASS_OPAQUE = 1,
+    PASS_SKY = 2,
+    PASS_TRANSPARENT = 3,
+    PASS_OVERLAY = 4
+};
+
+// One draw with the state it needs. Everything except the draw call itself
+// is applied through the state cache, so consecutive draws that share a
+// program, vertex array or texture do not rebind it.
+struct DrawCommand {
+    DrawCommand();
+
+    uint64_t key;
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int textureTarget; // texture is bound to unit 0 when non-zero
+    unsigned int texture;
+
+    bool depthTest;
+    unsigned int depthFunc;
+    float lineWidth;
+
+    unsigned int mode;
+    int count;          // indices, or vertices when not indexed
+    unsigned int firstIndex; // where the draw starts in a shared index buffer
+    unsigned int indexType;
+    int instanceCount;  // 0 for a non-instanced draw
+    bool indexed;
+
+    // Sets per-draw uniforms; runs after the program is bound
+    std::function<void()> setup;
+};
+
+// Collects a frame's draws, sorts them by key and submits them in order
+class RenderQueue {
+public:
+    // Sort key, most significant first: pass (4 bits), program, vertex
+    // array and material (12 bits each) and depth (24 bits). depth is a
+    // 0..1 distance; opaque passes sort it front to back, transparent back to front.
+    static uint64_t makeKey(RenderPass pass, unsigned int program, unsigned int vertexArray,
+        unsigned int material, float depth);
+
+    void submit(const DrawCommand& command);
+    void clear();
+    size_t size() const;
+
+    // Sorts by key (ties keep submission order) and draws every command
+    void execute(GLStateCache& state);
+
+private:
+    std::vector<DrawCommand> commands;
+    std::vector<uint32_t> order;
+};
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,121 @@
+#include "ShaderProgram.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <cstring>
+
+ShaderProgram::ShaderProgram(unsigned int program)
+    : id(program), uploadCount(0), skippedCount(0) {
+    if (id == 0) {
+        return;
+    }
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(id, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+
+        // Plain arrays are reported once as "name[0]"; register every element
+        std::string base = name;
+        if (base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0) {
+            base.erase(base.size() - 3);
+        }
+        for (GLint element = 0; element < size; ++element) {
+            std::string elementName = (size > 1 || base != name) ? base + "[" + std::to_string(element) + "]" : name;
+            GLint location = glGetUniformLocation(id, elementName.c_str());
+            if (location < 0) {
+                continue;
+            }
+            Uniform uniform = { location, false, {} };
+            handles[elementName] = (int)uniforms.size();
+            if (element == 0 && elementName != base) {
+                handles[base] = (int)uniforms.size();
+            }
+            uniforms.push_back(uniform);
+        }
+    }
+}
+
+ShaderProgram::~ShaderProgram() {
+    if (id != 0) {
+        glDeleteProgram(id);
+    }
+}
+
+void ShaderProgram::use() const {
+    glUseProgram(id);
+}
+
+unsigned int ShaderProgram::getId() const {
+    return id;
+}
+
+int ShaderProgram::getUniform(const std::string& name) const {
+    auto it = handles.find(name);
+    return it != handles.end() ? it->second : -1;
+}
+
+bool ShaderProgram::changed(Uniform& uniform, const void* data, size_t size) {
+    if (uniform.hasValue && std::memcmp(uniform.value, data, size) == 0) {
+        ++skippedCount;
+        return false;
+    }
+    std::memcpy(uniform.value, data, size);
+    uniform.hasValue = true;
+    ++uploadCount;
+    return true;
+}
+
+void ShaderProgram::setInt(int handle, int value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniform1i(uniform.location, value);
+    }
+}
+
+void ShaderProgram::setFloat(int handle, float value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniform1f(uniform.location, value);
+    }
+}
+
+void ShaderProgram::setVec3(int handle, const glm::vec3& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (changed(uniform, glm::value_ptr(value), sizeof(value))) {
+        glUniform3fv(uniform.location, 1, glm::value_ptr(value));
+    }
+}
+
+void ShaderProgram::setMat3(int handle, const glm::mat3& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (changed(uniform, glm::value_ptr(value), sizeof(value))) {
+        glUniformMatrix3fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+}
+
+void ShaderProgram::setMat4(int handle, const glm::mat4& value) {
+    if (handle < 0) return;
+    Uniform& uniform = uniforms[handle];
+    if (changed(uniform, glm::value_ptr(value), sizeof(value))) {
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+}
+
+size_t ShaderProgram::getUploadCount() const {
+    return uploadCount;
+}
+
+size_t ShaderProgram::getSkippedCount() const {
+    return skippedCount;
+}
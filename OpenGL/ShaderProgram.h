@@ -0,0 +1,60 @@
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Owns a linked program and every active uniform in it. Uniforms are looked
+// up once by name into integer handles; the typed setters remember the last
+// value uploaded through each handle and skip the GL call when it is unchanged.
+// Setters upload into the current program, so call use() first.
+class ShaderProgram {
+public:
+    // Takes ownership of an already linked program and introspects its uniforms
+    explicit ShaderProgram(unsigned int program = 0);
+
+    // Destructor to clean up OpenGL resources
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    void use() const;
+    unsigned int getId() const;
+
+    // Handle for an active uniform, or -1 when the program does not use it.
+    // Array elements are addressed as "name[i]"; "name" is element 0.
+    int getUniform(const std::string& name) const;
+
+    // Typed setters; a handle of -1 is ignored like GL location -1
+    void setInt(int uniform, int value);
+    void setFloat(int uniform, float value);
+    void setVec3(int uniform, const glm::vec3& value);
+    void setMat3(int uniform, const glm::mat3& value);
+    void setMat4(int uniform, const glm::mat4& value);
+
+    // Uploads issued and skipped because the value was unchanged
+    size_t getUploadCount() const;
+    size_t getSkippedCount() const;
+
+private:
+    struct Uniform {
+        GLint location;
+        bool hasValue;
+        float value[16];
+    };
+
+    // Returns true when the value differs from the cached one and caches it
+    bool changed(Uniform& uniform, const void* data, size_t size);
+
+    unsigned int id;
+    std::vector<Uniform> uniforms;
+    std::unordered_map<std::string, int> handles;
+    size_t uploadCount;
+    size_t skippedCount;
+};
+
+#endif // SHADER_PROGRAM_H
@@ -0,0 +1,32 @@
+#ifndef SKYBOX_SHADER_H
+#define SKYBOX_SHADER_H
+
+#include "CameraBuffer.h"
+
+// Skybox Vertex Shader - Updated with correct coordinate handling
+const char* skyboxVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+out vec3 TexCoords;
+)" CAMERA_BLOCK_GLSL R"(
+void main() {
+    TexCoords = aPos;
+    // Rotation only, so the skybox stays centered on the camera
+    gl_Position = projection * mat4(mat3(view)) * vec4(aPos, 1.0);
+    // Ensure depth is 1.0 (maximum depth)
+    gl_Position = gl_Position.xyww;
+}
+)";
+
+// Fragment Shader - No changes needed here
+const char* skyboxFragmentShaderSource = R"(
+#version 330 core
+in vec3 TexCoords;
+out vec4 FragColor;
+uniform samplerCube skybox;
+void main() {
+    FragColor = texture(skybox, TexCoords);
+}
+)";
+
+#endif // SKYBOX_SHADER_H
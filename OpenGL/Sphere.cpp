@@ -1,64 +1,61 @@
 #include "Sphere.h"
+#include "SphereTable.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <map>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-Sphere::Sphere(const glm::vec3& position, float radius, unsigned int sectors, unsigned int stacks)
-    : position(position), radius(radius), sectors(sectors), stacks(stacks),
-    color(glm::vec3(1.0f)), isSetup(false), VAO(0), VBO(0), EBO(0) {
-    generateVertices();
+// Live meshes by detail level; a mesh is freed when its last Sphere goes away
+static std::map<std::pair<unsigned int, unsigned int>, std::weak_ptr<SphereMesh>> meshCache;
+static std::map<unsigned int, std::weak_ptr<SphereMesh>> icoMeshCache;
+
+SphereMesh::~SphereMesh() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
 }
 
-Sphere::~Sphere() {
-    if (isSetup) {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
-    }
+Sphere::Sphere(const glm::vec3& position, float radius, unsigned int sectors, unsigned int stacks)
+    : position(position), radius(radius), sectors(sectors), stacks(stacks),
+    color(glm::vec3(1.0f)) {
 }
 
 void Sphere::generateVertices() {
-    vertices.clear();
-    indices.clear();
+    // Sized up front and written through pointers; every element is set below.
+    // Fewer than two stacks have no triangles, so the index list stays empty.
+    vertices.resize((stacks + 1) * (sectors + 1));
+    indices.resize(stacks > 1 ? 6 * sectors * (stacks - 1) : 0);
 
     float sectorStep = 2 * M_PI / sectors;
     float stackStep = M_PI / stacks;
 
+    // cos/sin of every sector angle (0 to 2pi), shared by all stacks
+    std::vector<float> sectorCos(sectors + 1), sectorSin(sectors + 1);
+    for (unsigned int j = 0; j <= sectors; ++j) {
+        float sectorAngle = j * sectorStep;
+        sectorCos[j] = cosf(sectorAngle);
+        sectorSin[j] = sinf(sectorAngle);
+    }
+
     // Generate vertices
+    SphereVertex* vertex = vertices.data();
     for (unsigned int i = 0; i <= stacks; ++i) {
         float stackAngle = M_PI / 2 - i * stackStep;  // starting from pi/2 to -pi/2
-        float xy = radius * cosf(stackAngle);         // r * cos(u)
-        float z = radius * sinf(stackAngle);          // r * sin(u)
+        float xy = cosf(stackAngle);                  // cos(u)
+        int16_t z = sphereSnorm16(sinf(stackAngle));      // sin(u)
 
         // Add (sectors+1) vertices per stack
-        // The first and last vertices have same position and normal, but different texture coordinates
-        for (unsigned int j = 0; j <= sectors; ++j) {
-            float sectorAngle = j * sectorStep;       // starting from 0 to 2pi
-
-            // Vertex position
-            float x = xy * cosf(sectorAngle);         // r * cos(u) * cos(v)
-            float y = xy * sinf(sectorAngle);         // r * cos(u) * sin(v)
-
-            // Normalized vertex normal
-            glm::vec3 normal = glm::normalize(glm::vec3(x, y, z));
-
-            // Add position
-            vertices.push_back(x + position.x);
-            vertices.push_back(y + position.y);
-            vertices.push_back(z + position.z);
-
-            // Add normal
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-
-            // Add color
-            vertices.push_back(color.r);
-            vertices.push_back(color.g);
-            vertices.push_back(color.b);
+        // The first and last vertices have the same position, but mark the texture seam
+        for (unsigned int j = 0; j <= sectors; ++j, ++vertex) {
+            vertex->x = sphereSnorm16(xy * sectorCos[j]);  // cos(u) * cos(v)
+            vertex->y = sphereSnorm16(xy * sectorSin[j]);  // cos(u) * sin(v)
+            vertex->z = z;
+            vertex->w = 0;
         }
     }
 
@@ -67,115 +64,318 @@ void Sphere::generateVertices() {
     // |  / |
     // | /  |
     // k2--k2+1
-    unsigned int k1, k2;
+    unsigned int* index = indices.data();
     for (unsigned int i = 0; i < stacks; ++i) {
-        k1 = i * (sectors + 1);
-        k2 = k1 + sectors + 1;
+        unsigned int k1 = i * (sectors + 1);
+        unsigned int k2 = k1 + sectors + 1;
 
+        // 2 triangles per sector excluding the first and last stacks
         for (unsigned int j = 0; j < sectors; ++j, ++k1, ++k2) {
-            // 2 triangles per sector excluding the first and last stacks
             if (i != 0) {
-                indices.push_back(k1);
-                indices.push_back(k2);
-                indices.push_back(k1 + 1);
+                index[0] = k1;
+                index[1] = k2;
+                index[2] = k1 + 1;
+                index += 3;
             }
 
             if (i != (stacks - 1)) {
-                indices.push_back(k1 + 1);
-                indices.push_back(k2);
-                indices.push_back(k2 + 1);
+                index[0] = k1 + 1;
+                index[1] = k2;
+                index[2] = k2 + 1;
+                index += 3;
             }
         }
     }
 }
 
+void Sphere::generateIcosphere(unsigned int frequency, std::vector<SphereVertex>& vertices,
+    std::vector<unsigned int>& indices) {
+    const unsigned int n = frequency;
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    const glm::vec3 corners[12] = {
+        { -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+        { 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+        { t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f }
+    };
+    // Counter-clockwise seen from outside
+    static const unsigned int faces[20][3] = {
+        { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+        { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+        { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+        { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 }
+    };
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(10 * n * n + 2);
+    for (const glm::vec3& corner : corners) {
+        positions.push_back(glm::normalize(corner));
+    }
+
+    // The n - 1 points inside an edge are created by the first face that
+    // reaches it, counted from the edge's lower corner so both faces agree
+    int edgeBase[12][12];
+    std::fill(&edgeBase[0][0], &edgeBase[0][0] + 12 * 12, -1);
+    auto edgePoint = [&](unsigned int a, unsigned int b, unsigned int step) {
+        unsigned int low = std::min(a, b), high = std::max(a, b);
+        if (a > b) {
+            step = n - step;
+        }
+        int& base = edgeBase[low][high];
+        if (base < 0) {
+            base = (int)positions.size();
+            for (unsigned int s = 1; s < n; ++s) {
+                positions.push_back(glm::normalize(corners[low] + (corners[high] - corners[low]) * ((float)s / n)));
+            }
+        }
+        return (unsigned int)base + step - 1;
+    };
+
+    // Triangular grid of each face: i steps towards its second corner, j
+    // towards its third; row i starts at i * (n + 1) - i * (i - 1) / 2
+    std::vector<unsigned int> grid((n + 1) * (n + 2) / 2);
+    indices.clear();
+    indices.reserve(60 * n * n);
+    for (const auto& face : faces) {
+        const unsigned int a = face[0], b = face[1], c = face[2];
+        for (unsigned int i = 0; i <= n; ++i) {
+            for (unsigned int j = 0; i + j <= n; ++j) {
+                unsigned int vertex;
+                if (i == 0 && j == 0) {
+                    vertex = a;
+                }
+                else if (i == n) {
+                    vertex = b;
+                }
+                else if (j == n) {
+                    vertex = c;
+                }
+                else if (j == 0) {
+                    vertex = edgePoint(a, b, i);
+                }
+                else if (i == 0) {
+                    vertex = edgePoint(a, c, j);
+                }
+                else if (i + j == n) {
+                    vertex = edgePoint(b, c, j);
+                }
+                else {
+                    vertex = (unsigned int)positions.size();
+                    positions.push_back(glm::normalize(corners[a] + (corners[b] - corners[a]) * ((float)i / n) +
+                        (corners[c] - corners[a]) * ((float)j / n)));
+                }
+                grid[i * (n + 1) - i * (i - 1) / 2 + j] = vertex;
+            }
+        }
+
+        for (unsigned int i = 0; i < n; ++i) {
+            unsigned int row = i * (n + 1) - i * (i - 1) / 2;
+            unsigned int nextRow = row + n + 1 - i;
+            for (unsigned int j = 0; i + j < n; ++j) {
+                indices.push_back(grid[row + j]);
+                indices.push_back(grid[nextRow + j]);
+                indices.push_back(grid[row + j + 1]);
+
+                if (i + j + 1 < n) {
+                    indices.push_back(grid[nextRow + j]);
+                    indices.push_back(grid[nextRow + j + 1]);
+                    indices.push_back(grid[row + j + 1]);
+                }
+            }
+        }
+    }
+
+    optimizeVertexCache(indices, positions.size());
+    remapVertices(positions, optimizeVertexFetch(indices, positions.size()));
+
+    vertices.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        vertices[i].x = sphereSnorm16(positions[i].x);
+        vertices[i].y = sphereSnorm16(positions[i].y);
+        vertices[i].z = sphereSnorm16(positions[i].z);
+        vertices[i].w = 0;
+    }
+}
+
+float Sphere::meshError(const std::vector<SphereVertex>& vertices, const std::vector<unsigned int>& indices) {
+    // Each triangle's vertices lie on the sphere, so the triangle is
+    // closest to the center (and farthest from the sphere) at the foot of
+    // the center on its plane
+    float error = 0.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::vec3 p[3];
+        for (int k = 0; k < 3; ++k) {
+            const SphereVertex& v = vertices[indices[i + k]];
+            p[k] = glm::vec3(v.x, v.y, v.z) / 32767.0f;
+        }
+        glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+        float length = glm::length(normal);
+        if (length > 0.0f) {
+            error = std::max(error, 1.0f - glm::dot(normal, p[0]) / length);
+        }
+    }
+    return error;
+}
+
+const std::vector<SphereVertex>& Sphere::getVertices() const {
+    return vertices;
+}
+
+const std::vector<unsigned int>& Sphere::getIndices() const {
+    return indices;
+}
+
 void Sphere::setup() {
-    if (isSetup) {
-        // Clean up previous VAO, VBO, EBO if already set up
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+    if (!mesh) {
+        mesh = acquireMesh(sectors, stacks);
     }
+}
+
+void SphereMesh::bindAttributes() const {
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(SphereVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+}
+
+// Uploads vertices and their indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+// into a new mesh
+static std::shared_ptr<SphereMesh> uploadMesh(const SphereVertex* vertices, size_t vertexCount,
+    const void* indices, size_t indexCount, unsigned int indexType) {
+    std::shared_ptr<SphereMesh> mesh = std::make_shared<SphereMesh>();
+    mesh->indexCount = (unsigned int)indexCount;
+    mesh->indexType = indexType;
 
     // Create and bind VAO
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    glGenVertexArrays(1, &mesh->VAO);
+    glBindVertexArray(mesh->VAO);
 
     // Create and bind VBO
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &mesh->VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(SphereVertex), vertices, GL_STATIC_DRAW);
 
     // Create and bind EBO
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // Set vertex attribute pointers
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    glGenBuffers(1, &mesh->EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
 
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Color attribute
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // Position attribute; color and center/radius stay disabled arrays and
+    // are read from the current attribute values set in render()
+    mesh->bindAttributes();
 
     // Unbind VAO
     glBindVertexArray(0);
 
-    isSetup = true;
+    return mesh;
 }
 
-void Sphere::render(unsigned int shaderProgram, const glm::mat4& view, const glm::mat4& projection) {
-    if (!isSetup) {
-        setup();
+// Uploads a generated mesh, with 16-bit indices when every vertex is
+// reachable with them
+static std::shared_ptr<SphereMesh> uploadGenerated(const std::vector<SphereVertex>& vertices,
+    const std::vector<unsigned int>& indices) {
+    if (vertices.size() <= 65536) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        return uploadMesh(vertices.data(), vertices.size(), shortIndices.data(), shortIndices.size(),
+            GL_UNSIGNED_SHORT);
     }
+    return uploadMesh(vertices.data(), vertices.size(), indices.data(), indices.size(), GL_UNSIGNED_INT);
+}
 
-    glUseProgram(shaderProgram);
+std::shared_ptr<SphereMesh> Sphere::acquireIcoMesh(unsigned int frequency) {
+    std::weak_ptr<SphereMesh>& cached = icoMeshCache[frequency];
+    std::shared_ptr<SphereMesh> mesh = cached.lock();
+    if (mesh) {
+        return mesh;
+    }
 
-    // Create model matrix
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
+    std::vector<SphereVertex> vertices;
+    std::vector<unsigned int> indices;
+    generateIcosphere(frequency, vertices, indices);
+    mesh = uploadGenerated(vertices, indices);
 
-    // Set matrices
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    cached = mesh;
+    return mesh;
+}
 
-    // Draw sphere
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+// Mesh of a detail level shipped as a compile-time SphereTable
+template <unsigned int Sectors, unsigned int Stacks>
+static std::shared_ptr<SphereMesh> uploadTable() {
+    const SphereTable<Sectors, Stacks>& table = sphereTable<Sectors, Stacks>();
+    return uploadMesh(table.vertices, table.VERTEX_COUNT, table.indices, table.INDEX_COUNT, GL_UNSIGNED_SHORT);
 }
 
+std::shared_ptr<SphereMesh> Sphere::acquireMesh(unsigned int sectors, unsigned int stacks) {
+    std::weak_ptr<SphereMesh>& cached = meshCache[std::make_pair(sectors, stacks)];
+    std::shared_ptr<SphereMesh> mesh = cached.lock();
+    if (mesh) {
+        return mesh;
+    }
 
+    if (sectors == 36 && stacks == 18) {
+        mesh = uploadTable<36, 18>();
+    }
+    else if (sectors == 12 && stacks == 12) {
+        mesh = uploadTable<12, 12>();
+    }
+    else {
+        Sphere unit(glm::vec3(0.0f), 1.0f, sectors, stacks);
+        unit.generateVertices();
+        mesh = uploadGenerated(unit.getVertices(), unit.getIndices());
+    }
+
+    cached = mesh;
+    return mesh;
+}
+
+std::shared_ptr<SphereMesh> Sphere::acquireImpostorQuad() {
+    static std::weak_ptr<SphereMesh> cached;
+    std::shared_ptr<SphereMesh> mesh = cached.lock();
+    if (mesh) {
+        return mesh;
+    }
+
+    // Corners at -1..1, counter-clockwise as seen from the camera
+    static const SphereVertex vertices[] = {
+        { -32767, -32767, 0, 0 },
+        {  32767, -32767, 0, 0 },
+        {  32767,  32767, 0, 0 },
+        { -32767,  32767, 0, 0 }
+    };
+    static const uint16_t indices[] = { 0, 1, 2, 2, 3, 0 };
+    mesh = uploadMesh(vertices, 4, indices, 6, GL_UNSIGNED_SHORT);
+
+    cached = mesh;
+    return mesh;
+}
+
+void Sphere::render(ShaderProgram& shader) {
+    if (!mesh) {
+        setup();
+    }
+
+    shader.use();
+
+    // Per-draw placement and color
+    glVertexAttrib4f(SPHERE_CENTER_RADIUS_ATTRIB, position.x, position.y, position.z, radius);
+    glVertexAttrib3f(SPHERE_COLOR_ATTRIB, color.r, color.g, color.b);
+
+    // Draw sphere
+    glBindVertexArray(mesh->VAO);
+    glDrawElements(GL_TRIANGLES, mesh->indexCount, mesh->indexType, 0);
+    glBindVertexArray(0);
+}
 
 void Sphere::setPosition(const glm::vec3& newPosition) {
     position = newPosition;
-    generateVertices();  // Regenerate vertices with new position
-    if (isSetup) {
-        setup();  // Update the buffers
-    }
 }
 
 void Sphere::setRadius(float newRadius) {
     radius = newRadius;
-    generateVertices();  // Regenerate vertices with new radius
-    if (isSetup) {
-        setup();  // Update the buffers
-    }
 }
 
 void Sphere::setColor(const glm::vec3& newColor) {
     color = newColor;
-    generateVertices();  // Regenerate vertices with new color
-    if (isSetup) {
-        setup();  // Update the buffers
-    }
 }
 
 glm::vec3 Sphere::getPosition() const {
@@ -188,4 +388,11 @@ float Sphere::getRadius() const {
 
 glm::vec3 Sphere::getColor() const {
     return color;
+}
+
+BoundingSphere Sphere::getBounds() const {
+    BoundingSphere bounds;
+    bounds.center = position;
+    bounds.radius = radius;
+    return bounds;
 }
\ No newline at end of file
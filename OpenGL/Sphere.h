@@ -3,24 +3,60 @@
 
 #include <glm/glm.hpp>
 #include <glad/glad.h>
+#include <cstdint>
 #include <vector>
+#include <memory>
+#include "ShaderProgram.h"
+#include "Frustum.h"
 
+// Vertex attribute slots for the per-target values (see sphereVertexShaderSource)
+#define SPHERE_COLOR_ATTRIB 2
+#define SPHERE_CENTER_RADIUS_ATTRIB 3
+
+// Unit-sphere vertex as normalized 16-bit integers (x, y, z and padding to
+// 8 bytes). On a unit sphere the position is also the normal.
+struct SphereVertex {
+    int16_t x, y, z, w;
+};
+
+// How a unit-sphere mesh is tessellated
+enum SphereShape {
+    SPHERE_SHAPE_UV,  // sectors x stacks grid of latitude and longitude lines
+    SPHERE_SHAPE_ICO  // subdivided icosahedron
+};
+
+// GPU copy of a unit sphere, shared by every Sphere with the same detail level
+struct SphereMesh {
+    unsigned int VAO, VBO, EBO;
+    unsigned int indexCount;
+    unsigned int indexType; // GL_UNSIGNED_SHORT when the vertex count allows
+
+    // Points attribute 0 at the vertex buffer and binds the index buffer
+    // on the currently bound vertex array
+    void bindAttributes() const;
+
+    ~SphereMesh();
+};
+
+// A target drawn from the shared unit-sphere mesh. Position, radius and color
+// are per-draw vertex attributes, so changing them never touches GL buffers.
 class Sphere {
 public:
+    // Icosphere frequency whose silhouette error is no larger than that of
+    // the default 36x18 UV sphere (980 triangles instead of 1224)
+    static const unsigned int DEFAULT_ICO_FREQUENCY = 7;
+
     // Constructor with parameters for position, radius, and detail level
     Sphere(const glm::vec3& position = glm::vec3(0.0f),
         float radius = 1.0f,
         unsigned int sectors = 36,
         unsigned int stacks = 18);
 
-    // Destructor to clean up OpenGL resources
-    ~Sphere();
-
-    // Setup method to initialize the sphere's VAO, VBO, and EBO
+    // Attaches the shared unit-sphere mesh for this detail level
     void setup();
 
-    // Render method to draw the sphere
-    void render(unsigned int shaderProgram, const glm::mat4& view, const glm::mat4& projection);
+    // Render method to draw the sphere; view/projection must already be set on the program
+    void render(ShaderProgram& shader);
 
     // Getters and setters for sphere properties
     void setPosition(const glm::vec3& newPosition);
@@ -30,12 +66,43 @@ public:
     glm::vec3 getPosition() const;
     float getRadius() const;
     glm::vec3 getColor() const;
-    
 
-private:
-    // Method to generate vertices and indices for sphere
+    // World-space bounds, exactly the sphere itself
+    BoundingSphere getBounds() const;
+
+    // Method to generate vertices and indices for a unit sphere at the origin.
+    // Trigonometry is evaluated once per stack and once per sector. Fewer than
+    // two stacks or no sectors give no indices.
     void generateVertices();
 
+    // Mesh data, only filled by generateVertices
+    const std::vector<SphereVertex>& getVertices() const;
+    const std::vector<unsigned int>& getIndices() const;
+
+    // Icosahedron with every edge split into frequency segments, projected
+    // onto the unit sphere: 20 * frequency^2 near-equal triangles instead of
+    // the UV sphere's slivers at the poles. Triangles are ordered for the
+    // post-transform cache and vertices in the order they are first used.
+    static void generateIcosphere(unsigned int frequency, std::vector<SphereVertex>& vertices,
+        std::vector<unsigned int>& indices);
+
+    // Largest distance between the triangles of a unit-sphere mesh and the
+    // sphere, as a fraction of the radius; this is the silhouette error
+    static float meshError(const std::vector<SphereVertex>& vertices, const std::vector<unsigned int>& indices);
+
+    // Shared unit-sphere mesh for a detail level, uploaded on first use.
+    // Attribute 0 (position, also the normal) is set up in its VAO.
+    static std::shared_ptr<SphereMesh> acquireMesh(unsigned int sectors, unsigned int stacks);
+
+    // Same for the icosphere of the given frequency
+    static std::shared_ptr<SphereMesh> acquireIcoMesh(unsigned int frequency);
+
+    // Shared quad with the same attribute layout, drawn once per target by
+    // the ray-casting impostor shader (sphereImpostorVertexShaderSource)
+    static std::shared_ptr<SphereMesh> acquireImpostorQuad();
+
+private:
+
     // Sphere properties
     glm::vec3 position;
     float radius;
@@ -43,13 +110,12 @@ private:
     unsigned int stacks;   // Latitude divisions
     glm::vec3 color;
 
-    // OpenGL objects
-    unsigned int VAO, VBO, EBO;
+    // Shared GPU mesh
+    std::shared_ptr<SphereMesh> mesh;
 
-    // Mesh data
-    std::vector<float> vertices;
+    // Mesh data, only filled by generateVertices
+    std::vector<SphereVertex> vertices;
     std::vector<unsigned int> indices;
-    bool isSetup;
 };
 
 #endif // SPHERE_H
\ No newline at end of file
@@ -1,31 +1,57 @@
 ﻿#ifndef SPHERE_SHADER_H
 #define SPHERE_SHADER_H
 
+#include "CameraBuffer.h"
+#include "LightBuffer.h"
+#include "MaterialBuffer.h"
+
 // Vertex Shader for Sphere with multiple lights
 const char* sphereVertexShaderSource = R"(
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec3 aPos; // unit sphere, so also the normal
 layout (location = 2) in vec3 aColor;
+layout (location = 3) in vec4 aCenterRadius; // xyz = world center, w = radius
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec3 OurColor;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+)" CAMERA_BLOCK_GLSL R"(
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    // Calculate normal in world coordinates
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    // Unit sphere scaled and moved into place; uniform scale leaves normals unchanged
+    FragPos = aCenterRadius.xyz + aPos * aCenterRadius.w;
+    Normal = aPos;
     OurColor = aColor;
     
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = viewProj * vec4(FragPos, 1.0);
 }
 )";
 
+// Phong lighting of a target surface point from every light in the Lights
+// block, tone mapped; shared by the mesh and impostor fragment shaders.
+// Needs the Camera and Lights blocks and a shininess uniform declared first.
+#define SPHERE_SHADING_GLSL \
+    "vec3 shadeSphere(vec3 fragPos, vec3 norm, vec3 color) {\n" \
+    "    vec3 viewDir = normalize(cameraPos - fragPos);\n" \
+    "    vec3 result = vec3(0.1) * color;\n" \
+    "    for (int i = 0; i < numLights && i < MAX_LIGHTS; i++) {\n" \
+    "        vec3 lightDir = normalize(lights[i].position - fragPos);\n" \
+    "        float distance = length(lights[i].position - fragPos);\n" \
+    "        float attenuation = 1.0 / (lights[i].constant +\n" \
+    "                                   lights[i].linear * distance +\n" \
+    "                                   lights[i].quadratic * distance * distance);\n" \
+    "        vec3 ambient = lights[i].ambient * lights[i].color;\n" \
+    "        float diff = max(dot(norm, lightDir), 0.0);\n" \
+    "        vec3 diffuse = lights[i].diffuse * diff * lights[i].color;\n" \
+    "        vec3 reflectDir = reflect(-lightDir, norm);\n" \
+    "        float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);\n" \
+    "        vec3 specular = lights[i].specular * spec * lights[i].color;\n" \
+    "        result += (ambient + diffuse + specular) * attenuation * color;\n" \
+    "    }\n" \
+    "    return result / (result + vec3(1.0));\n" \
+    "}\n"
+
 // Fragment Shader for Sphere with multiple lights
 const char* sphereFragmentShaderSource = R"(
 #version 330 core
@@ -35,66 +61,97 @@ in vec3 OurColor;
 
 out vec4 FragColor;
 
-#define MAX_LIGHTS 8
+)" CAMERA_BLOCK_GLSL LIGHT_BLOCK_GLSL R"(
+uniform float shininess;
 
-struct Light {
-    vec3 position;
-    vec3 color;
-    
-    // Light properties
-    float ambient;
-    float diffuse;
-    float specular;
-    
-    // Attenuation
-    float constant;
-    float linear;
-    float quadratic;
-};
-
-uniform Light lights[MAX_LIGHTS];
-uniform int numLights;
-uniform vec3 viewPos;   // Camera position for specular reflection
+)" SPHERE_SHADING_GLSL R"(
+
+void main() {
+    FragColor = vec4(shadeSphere(FragPos, normalize(Normal), OurColor), 1.0);
+}
+)";
+
+// Camera-facing quad per target, placed where it touches the front of the
+// sphere and sized to cover the sphere's silhouette cone there. Every ray
+// hit lies behind the quad, so the fragment shader only ever pushes depth
+// back and early depth rejection keeps working (depth_greater).
+const char* sphereImpostorVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos; // quad corner in -1..1, z unused
+layout (location = 2) in vec3 aColor;
+layout (location = 3) in vec4 aCenterRadius; // xyz = world center, w = radius
+
+out vec3 FragPos;
+flat out vec4 CenterRadius;
+flat out vec3 OurColor;
+
+)" CAMERA_BLOCK_GLSL R"(
+
+void main() {
+    vec3 center = aCenterRadius.xyz;
+    float radius = aCenterRadius.w;
+
+    vec3 toCenter = center - cameraPos;
+    float distanceSq = dot(toCenter, toCenter);
+    float distance = sqrt(distanceSq);
+    vec3 forward = toCenter / distance;
+    vec3 cameraUp = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 right = normalize(cross(forward, cameraUp));
+    vec3 up = cross(right, forward);
+
+    // Half-size of the silhouette cone at the tangent plane. With the
+    // camera inside the sphere the quad falls behind it and nothing is drawn.
+    float extent = (distance - radius) * radius * inversesqrt(max(distanceSq - radius * radius, 1e-6));
+
+    FragPos = center - forward * radius + (aPos.x * right + aPos.y * up) * extent;
+    CenterRadius = aCenterRadius;
+    OurColor = aColor;
+
+    gl_Position = viewProj * vec4(FragPos, 1.0);
+}
+)";
+
+// Intersects the eye ray with the exact sphere, writes its depth and lights
+// it with the analytic normal
+const char* sphereImpostorFragmentShaderSource = R"(
+#version 330 core
+#extension GL_ARB_conservative_depth : enable
+#ifdef GL_ARB_conservative_depth
+layout (depth_greater) out float gl_FragDepth;
+#endif
+in vec3 FragPos;
+flat in vec4 CenterRadius;
+flat in vec3 OurColor;
+
+out vec4 FragColor;
+
+)" CAMERA_BLOCK_GLSL LIGHT_BLOCK_GLSL R"(
 uniform float shininess;
 
+)" SPHERE_SHADING_GLSL R"(
+
 void main() {
-    vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    
-    // Initialize with global ambient light
-    vec3 result = vec3(0.1) * OurColor;
-    
-    // Calculate contribution from each light
-    for(int i = 0; i < numLights && i < MAX_LIGHTS; i++) {
-        // Calculate direction and distance to light
-        vec3 lightDir = normalize(lights[i].position - FragPos);
-        float distance = length(lights[i].position - FragPos);
-        
-        // Calculate attenuation
-        float attenuation = 1.0 / (lights[i].constant + 
-                                 lights[i].linear * distance + 
-                                 lights[i].quadratic * distance * distance);
-        
-        // Ambient component
-        vec3 ambient = lights[i].ambient * lights[i].color;
-        
-        // Diffuse component  
-        float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = lights[i].diffuse * diff * lights[i].color;
-        
-        // Specular component
-        vec3 reflectDir = reflect(-lightDir, norm);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-        vec3 specular = lights[i].specular * spec * lights[i].color;
-        
-        // Apply attenuation and add this light's contribution
-        result += (ambient + diffuse + specular) * attenuation * OurColor;
+    // Same quadratic as raySphereIntersection, with a normalized direction
+    vec3 rayDir = normalize(FragPos - cameraPos);
+    vec3 oc = cameraPos - CenterRadius.xyz;
+    float b = dot(oc, rayDir);
+    float c = dot(oc, oc) - CenterRadius.w * CenterRadius.w;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0) {
+        discard;
     }
-    
-    // Apply tone mapping to prevent over-exposure when using multiple lights
-    result = result / (result + vec3(1.0));
-    
-    FragColor = vec4(result, 1.0);
+    float s = sqrt(discriminant);
+    float t = (-b - s > 0.0) ? -b - s : -b + s;
+    if (t <= 0.0) {
+        discard;
+    }
+
+    vec3 hit = cameraPos + t * rayDir;
+    vec4 clip = viewProj * vec4(hit, 1.0);
+    gl_FragDepth = (clip.z / clip.w) * 0.5 + 0.5;
+
+    vec3 norm = (hit - CenterRadius.xyz) / CenterRadius.w;
+    FragColor = vec4(shadeSphere(hit, norm, OurColor), 1.0);
 }
 )";
 
@@ -109,20 +166,19 @@ out vec3 Position;
 out vec3 ReflectDir;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform vec3 cameraPos;
+uniform mat3 normalMatrix; // inverse transpose of model, computed on the CPU
+)" CAMERA_BLOCK_GLSL R"(
 
 void main() {
     vec4 worldPos = model * vec4(aPos, 1.0);
     Position = worldPos.xyz;
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
     
     // Pre-calculate reflection direction
     vec3 viewDir = normalize(Position - cameraPos);
     ReflectDir = reflect(viewDir, normalize(Normal));
     
-    gl_Position = projection * view * worldPos;
+    gl_Position = viewProj * worldPos;
 }
 )";
 
@@ -135,7 +191,7 @@ in vec3 Normal;
 in vec3 Position;
 in vec3 ReflectDir;
 
-uniform vec3 cameraPos;
+)" CAMERA_BLOCK_GLSL R"(
 uniform samplerCube skybox;
 
 void main() {
@@ -163,15 +219,14 @@ out vec3 ReflectDir;
 out vec3 RefractDir;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform vec3 cameraPos;
+uniform mat3 normalMatrix; // inverse transpose of model, computed on the CPU
+)" CAMERA_BLOCK_GLSL R"(
 uniform float refractionRatio;
 
 void main() {
     vec4 worldPos = model * vec4(aPos, 1.0);
     Position = worldPos.xyz;
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
     
     // Pre-calculate directions
     vec3 viewDir = normalize(Position - cameraPos);
@@ -180,7 +235,7 @@ void main() {
     ReflectDir = reflect(viewDir, normalizedNormal);
     RefractDir = refract(viewDir, normalizedNormal, refractionRatio);
     
-    gl_Position = projection * view * worldPos;
+    gl_Position = viewProj * worldPos;
 }
 )";
 
@@ -194,7 +249,7 @@ in vec3 Position;
 in vec3 ReflectDir;
 in vec3 RefractDir;
 
-uniform vec3 cameraPos;
+)" CAMERA_BLOCK_GLSL R"(
 uniform samplerCube skybox;
 uniform float transparency; // Control transparency level (0.0 = opaque, 1.0 = fully transparent)
 
@@ -231,6 +286,14 @@ void main() {
 }
 )";
 
+// Attaches a uniform block the program declares to its shared buffer binding
+void bindSharedUniformBlock(unsigned int program, const char* blockName, unsigned int binding) {
+    GLuint index = glGetUniformBlockIndex(program, blockName);
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, index, binding);
+    }
+}
+
 // Function to compile special shaders with improved error handling
 int compileSpecialShader(const char* vertexSource, const char* fragmentSource, const char* shaderName) {
     int success;
@@ -273,6 +336,11 @@ int compileSpecialShader(const char* vertexSource, const char* fragmentSource, c
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 
+    // Per-frame data is written once and read by every program
+    bindSharedUniformBlock(shaderProgram, "Camera", CAMERA_BUFFER_BINDING);
+    bindSharedUniformBlock(shaderProgram, "Lights", LIGHT_BUFFER_BINDING);
+    bindSharedUniformBlock(shaderProgram, "Materials", MATERIAL_BUFFER_BINDING);
+
     return shaderProgram;
 }
 
@@ -0,0 +1,93 @@
+#ifndef SPHERE_TABLE_H
+#define SPHERE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Sphere.h"
+
+// Normalized 16-bit integer for a value in -1..1, rounded to nearest
+constexpr int16_t sphereSnorm16(float value) {
+    return (int16_t)(value * 32767.0f + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+// sin/cos usable in constant expressions, for angles in -pi..2pi. Taylor
+// series in double, so the result rounded to float matches sinf/cosf.
+constexpr double sphereSin(double x) {
+    const double pi = 3.14159265358979323846;
+    if (x > pi) {
+        x -= 2.0 * pi;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 20; ++n) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double sphereCos(double x) {
+    return sphereSin(x + 3.14159265358979323846 / 2.0);
+}
+
+// Unit-sphere vertices and indices for a fixed detail level, built at
+// compile time with the same angles, float rounding and triangle order as
+// Sphere::generateVertices. MicroBench checks the two agree.
+template <unsigned int Sectors, unsigned int Stacks>
+struct SphereTable {
+    static const size_t VERTEX_COUNT = (Stacks + 1) * (Sectors + 1);
+    static const size_t INDEX_COUNT = 6 * Sectors * (Stacks - 1);
+    static_assert(VERTEX_COUNT <= 65536, "sphere tables use 16-bit indices");
+
+    SphereVertex vertices[VERTEX_COUNT];
+    uint16_t indices[INDEX_COUNT];
+
+    constexpr SphereTable() : vertices(), indices() {
+        const float sectorStep = (float)(2 * 3.14159265358979323846 / Sectors);
+        const float stackStep = (float)(3.14159265358979323846 / Stacks);
+
+        size_t vertex = 0;
+        for (unsigned int i = 0; i <= Stacks; ++i) {
+            const float stackAngle = (float)(3.14159265358979323846 / 2 - i * stackStep);
+            const float xy = (float)sphereCos(stackAngle);
+            const int16_t z = sphereSnorm16((float)sphereSin(stackAngle));
+
+            for (unsigned int j = 0; j <= Sectors; ++j, ++vertex) {
+                const float sectorAngle = j * sectorStep;
+                vertices[vertex].x = sphereSnorm16(xy * (float)sphereCos(sectorAngle));
+                vertices[vertex].y = sphereSnorm16(xy * (float)sphereSin(sectorAngle));
+                vertices[vertex].z = z;
+                vertices[vertex].w = 0;
+            }
+        }
+
+        size_t index = 0;
+        for (unsigned int i = 0; i < Stacks; ++i) {
+            unsigned int k1 = i * (Sectors + 1);
+            unsigned int k2 = k1 + Sectors + 1;
+
+            for (unsigned int j = 0; j < Sectors; ++j, ++k1, ++k2) {
+                if (i != 0) {
+                    indices[index++] = (uint16_t)k1;
+                    indices[index++] = (uint16_t)k2;
+                    indices[index++] = (uint16_t)(k1 + 1);
+                }
+
+                if (i != (Stacks - 1)) {
+                    indices[index++] = (uint16_t)(k1 + 1);
+                    indices[index++] = (uint16_t)k2;
+                    indices[index++] = (uint16_t)(k2 + 1);
+                }
+            }
+        }
+    }
+};
+
+// The table for a detail level, evaluated by the compiler into read-only data
+template <unsigned int Sectors, unsigned int Stacks>
+const SphereTable<Sectors, Stacks>& sphereTable() {
+    static constexpr SphereTable<Sectors, Stacks> table;
+    return table;
+}
+
+#endif // SPHERE_TABLE_H
@@ -0,0 +1,96 @@
+#include "TargetField.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Below this many targets the SIMD linear scan beats walking the grid
+const size_t INDEX_MIN_TARGETS = 256;
+
+// Average number of targets per cell the grid is sized for
+const float TARGETS_PER_CELL = 2.0f;
+
+} // namespace
+
+size_t TargetField::add(const glm::vec3& center, float r) {
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radius.push_back(r);
+    if (grid.isBuilt()) {
+        grid.insert((unsigned int)(radius.size() - 1), center, r);
+    }
+    return radius.size() - 1;
+}
+
+void TargetField::set(size_t index, const glm::vec3& center, float r) {
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    radius[index] = r;
+    if (grid.isBuilt()) {
+        grid.update((unsigned int)index, center, r);
+    }
+}
+
+void TargetField::buildIndex(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float margin, float maxRadius) {
+    // Cells no smaller than a target's reach keep each target in at most
+    // 27 cells; sparse fields get larger cells instead
+    if (!radius.empty()) {
+        maxRadius = std::max(maxRadius, *std::max_element(radius.begin(), radius.end()));
+    }
+    maxRadius = maxRadius > 0.0f ? maxRadius : 1.0f;
+    float reach = maxRadius + margin;
+    glm::vec3 extent = boundsMax - boundsMin;
+    float volume = extent.x * extent.y * extent.z;
+    float sparseSize = std::cbrt(volume * TARGETS_PER_CELL / std::max<size_t>(radius.size(), 1));
+    float cellSize = std::max(reach, sparseSize);
+
+    // Grow the grid by the reach so targets spawned at the edge of the
+    // volume still fit instead of landing on the overflow list
+    grid.reset(boundsMin - glm::vec3(reach), boundsMax + glm::vec3(reach), cellSize, margin);
+    for (size_t i = 0; i < radius.size(); ++i) {
+        grid.insert((unsigned int)i, getCenter(i), radius[i]);
+    }
+}
+
+bool TargetField::isIndexed() const {
+    return grid.isBuilt();
+}
+
+void TargetField::reserve(size_t count) {
+    centerX.reserve(count);
+    centerY.reserve(count);
+    centerZ.reserve(count);
+    radius.reserve(count);
+}
+
+void TargetField::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+    grid.clear();
+}
+
+size_t TargetField::size() const {
+    return radius.size();
+}
+
+glm::vec3 TargetField::getCenter(size_t index) const {
+    return glm::vec3(centerX[index], centerY[index], centerZ[index]);
+}
+
+float TargetField::getRadius(size_t index) const {
+    return radius[index];
+}
+
+RayHit TargetField::closestHit(const glm::vec3& rayOrigin, const glm::vec3& rayDir, float tolerance) const {
+    glm::vec3 dir = glm::normalize(rayDir);
+    if (grid.isBuilt() && radius.size() >= INDEX_MIN_TARGETS && tolerance <= grid.getMargin()) {
+        return grid.closestHit(centerX.data(), centerY.data(), centerZ.data(), radius.data(),
+            rayOrigin, dir, tolerance);
+    }
+    return closestRaySphereHit(centerX.data(), centerY.data(), centerZ.data(), radius.data(),
+        radius.size(), rayOrigin, dir, tolerance);
+}
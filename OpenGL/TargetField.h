@@ -0,0 +1,47 @@
+#ifndef TARGET_FIELD_H
+#define TARGET_FIELD_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "HitTest.h"
+#include "TargetGrid.h"
+
+// Target centers and radii stored as structure-of-arrays so hit tests can
+// stream them through the SIMD closest-hit kernel. Large fields can add a
+// spatial index so a click only tests the targets near the ray.
+class TargetField {
+public:
+    // Appends a target and returns its index
+    size_t add(const glm::vec3& center, float radius);
+
+    // Moves and resizes an existing target
+    void set(size_t index, const glm::vec3& center, float radius);
+
+    // Indexes all current and future targets in a grid over the given spawn
+    // volume. margin is the largest tolerance closestHit will be called with;
+    // queries with a larger tolerance fall back to the linear scan. maxRadius
+    // is the largest radius targets will be given later; the cells are sized
+    // for it or for the current largest target, whichever is bigger.
+    void buildIndex(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float margin, float maxRadius = 0.0f);
+    bool isIndexed() const;
+
+    void reserve(size_t count);
+    void clear();
+    size_t size() const;
+
+    glm::vec3 getCenter(size_t index) const;
+    float getRadius(size_t index) const;
+
+    // Nearest target along the ray; tolerance is added to every radius
+    RayHit closestHit(const glm::vec3& rayOrigin, const glm::vec3& rayDir, float tolerance = 0.0f) const;
+
+private:
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    TargetGrid grid;
+};
+
+#endif // TARGET_FIELD_H
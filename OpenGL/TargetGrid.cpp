@@ -0,0 +1,191 @@
+#include "TargetGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Extra padding on every target's box so rounding in the hit distance can
+// never place a hit point just outside the cells the target is listed in
+const float BOUNDS_SLACK = 1e-3f;
+
+// Upper bound on cells per axis, keeps a tiny cell size from exhausting memory
+const int MAX_DIM = 64;
+
+void removeIndex(std::vector<unsigned int>& list, unsigned int index) {
+    auto it = std::find(list.begin(), list.end(), index);
+    if (it != list.end()) {
+        *it = list.back();
+        list.pop_back();
+    }
+}
+
+} // namespace
+
+TargetGrid::TargetGrid()
+    : boundsMin(0.0f), boundsMax(0.0f), cellSize(1.0f), inverseCellSize(1.0f), margin(0.0f) {
+    dims[0] = dims[1] = dims[2] = 0;
+}
+
+void TargetGrid::reset(const glm::vec3& newMin, const glm::vec3& newMax, float newCellSize, float newMargin) {
+    boundsMin = newMin;
+    margin = newMargin;
+    glm::vec3 extent = newMax - newMin;
+    float largest = std::max(extent.x, std::max(extent.y, extent.z));
+    cellSize = std::max(newCellSize, largest / MAX_DIM);
+    inverseCellSize = 1.0f / cellSize;
+    for (int axis = 0; axis < 3; ++axis) {
+        dims[axis] = std::max(1, (int)std::ceil(extent[axis] * inverseCellSize));
+    }
+    boundsMax = boundsMin + glm::vec3((float)dims[0], (float)dims[1], (float)dims[2]) * cellSize;
+
+    cells.assign((size_t)dims[0] * dims[1] * dims[2], std::vector<unsigned int>());
+    overflow.clear();
+    ranges.clear();
+}
+
+void TargetGrid::insert(unsigned int index, const glm::vec3& center, float radius) {
+    if (ranges.size() <= index) {
+        ranges.resize(index + 1);
+    }
+    ranges[index] = cellRange(center, radius);
+    addToCells(index, ranges[index]);
+}
+
+void TargetGrid::update(unsigned int index, const glm::vec3& center, float radius) {
+    CellRange range = cellRange(center, radius);
+    const CellRange& old = ranges[index];
+    if (range.overflow == old.overflow &&
+        std::equal(range.min, range.min + 3, old.min) && std::equal(range.max, range.max + 3, old.max)) {
+        return;
+    }
+    removeFromCells(index, old);
+    ranges[index] = range;
+    addToCells(index, range);
+}
+
+void TargetGrid::clear() {
+    cells.clear();
+    overflow.clear();
+    ranges.clear();
+    dims[0] = dims[1] = dims[2] = 0;
+}
+
+bool TargetGrid::isBuilt() const {
+    return !cells.empty();
+}
+
+float TargetGrid::getMargin() const {
+    return margin;
+}
+
+TargetGrid::CellRange TargetGrid::cellRange(const glm::vec3& center, float radius) const {
+    CellRange range;
+    float reach = radius + margin + BOUNDS_SLACK;
+    glm::vec3 lo = center - glm::vec3(reach);
+    glm::vec3 hi = center + glm::vec3(reach);
+    range.overflow = false;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (lo[axis] < boundsMin[axis] || hi[axis] > boundsMax[axis]) {
+            range.overflow = true;
+        }
+        range.min[axis] = std::min(std::max((int)((lo[axis] - boundsMin[axis]) * inverseCellSize), 0), dims[axis] - 1);
+        range.max[axis] = std::min(std::max((int)((hi[axis] - boundsMin[axis]) * inverseCellSize), 0), dims[axis] - 1);
+    }
+    return range;
+}
+
+void TargetGrid::addToCells(unsigned int index, const CellRange& range) {
+    if (range.overflow) {
+        overflow.push_back(index);
+        return;
+    }
+    for (int z = range.min[2]; z <= range.max[2]; ++z)
+        for (int y = range.min[1]; y <= range.max[1]; ++y)
+            for (int x = range.min[0]; x <= range.max[0]; ++x)
+                cells[cellIndex(x, y, z)].push_back(index);
+}
+
+void TargetGrid::removeFromCells(unsigned int index, const CellRange& range) {
+    if (range.overflow) {
+        removeIndex(overflow, index);
+        return;
+    }
+    for (int z = range.min[2]; z <= range.max[2]; ++z)
+        for (int y = range.min[1]; y <= range.max[1]; ++y)
+            for (int x = range.min[0]; x <= range.max[0]; ++x)
+                removeIndex(cells[cellIndex(x, y, z)], index);
+}
+
+int TargetGrid::cellIndex(int x, int y, int z) const {
+    return (z * dims[1] + y) * dims[0] + x;
+}
+
+RayHit TargetGrid::closestHit(const float* cx, const float* cy, const float* cz, const float* r,
+    const glm::vec3& o, const glm::vec3& d, float tolerance) const {
+    RayHit best = { -1, INFINITY };
+    closestRaySphereHitSubset(cx, cy, cz, r, overflow.data(), overflow.size(), o, d, tolerance, best);
+
+    // Clip the ray against the grid box (slab test)
+    float tEnter = 0.0f;
+    float tExit = INFINITY;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (d[axis] == 0.0f) {
+            if (o[axis] < boundsMin[axis] || o[axis] > boundsMax[axis]) {
+                return best;
+            }
+            continue;
+        }
+        float inv = 1.0f / d[axis];
+        float t0 = (boundsMin[axis] - o[axis]) * inv;
+        float t1 = (boundsMax[axis] - o[axis]) * inv;
+        if (t0 > t1) std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+    }
+    if (tEnter > tExit || best.t < tEnter) {
+        return best;
+    }
+
+    // 3D DDA from the entry cell
+    glm::vec3 start = o + d * tEnter;
+    int cell[3], step[3], last[3];
+    float tMax[3], tDelta[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        cell[axis] = std::min(std::max((int)((start[axis] - boundsMin[axis]) * inverseCellSize), 0), dims[axis] - 1);
+        if (d[axis] > 0.0f) {
+            step[axis] = 1;
+            last[axis] = dims[axis];
+            tMax[axis] = tEnter + (boundsMin[axis] + (cell[axis] + 1) * cellSize - start[axis]) / d[axis];
+            tDelta[axis] = cellSize / d[axis];
+        }
+        else if (d[axis] < 0.0f) {
+            step[axis] = -1;
+            last[axis] = -1;
+            tMax[axis] = tEnter + (boundsMin[axis] + cell[axis] * cellSize - start[axis]) / d[axis];
+            tDelta[axis] = -cellSize / d[axis];
+        }
+        else {
+            step[axis] = 0;
+            last[axis] = -2;
+            tMax[axis] = INFINITY;
+            tDelta[axis] = INFINITY;
+        }
+    }
+
+    for (;;) {
+        const std::vector<unsigned int>& list = cells[cellIndex(cell[0], cell[1], cell[2])];
+        closestRaySphereHitSubset(cx, cy, cz, r, list.data(), list.size(), o, d, tolerance, best);
+
+        int axis = (tMax[0] < tMax[1]) ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        float cellExit = std::min(tMax[axis], tExit);
+        if (best.t < cellExit || cellExit >= tExit) {
+            break;
+        }
+        cell[axis] += step[axis];
+        if (cell[axis] == last[axis]) {
+            break;
+        }
+        tMax[axis] += tDelta[axis];
+    }
+    return best;
+}
@@ -0,0 +1,60 @@
+#ifndef TARGET_GRID_H
+#define TARGET_GRID_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "HitTest.h"
+
+// Uniform grid over the spawn volume for ray queries against many targets.
+// Each target is listed in every cell its bounding box (radius + margin)
+// overlaps; targets that stick out of the grid go to an overflow list that is
+// always tested. Queries walk the cells along the ray front to back and stop
+// as soon as the nearest hit lies before the current cell's exit.
+class TargetGrid {
+public:
+    TargetGrid();
+
+    // Discards all cells and sets up an empty grid over the given bounds.
+    // margin is the largest tolerance that closestHit will be called with.
+    void reset(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float cellSize, float margin);
+
+    // Adds a new target; indices must be inserted in order
+    void insert(unsigned int index, const glm::vec3& center, float radius);
+
+    // Moves a target to new cells; no-op when its cell range is unchanged
+    void update(unsigned int index, const glm::vec3& center, float radius);
+
+    void clear();
+    bool isBuilt() const;
+    float getMargin() const;
+
+    // Nearest target along a normalized ray; tolerance must not exceed the margin
+    RayHit closestHit(const float* centerX, const float* centerY, const float* centerZ,
+        const float* radius, const glm::vec3& rayOrigin, const glm::vec3& rayDir, float tolerance) const;
+
+private:
+    // Inclusive cell range covered by a target, or overflow when outside the grid
+    struct CellRange {
+        int min[3];
+        int max[3];
+        bool overflow;
+    };
+
+    CellRange cellRange(const glm::vec3& center, float radius) const;
+    void addToCells(unsigned int index, const CellRange& range);
+    void removeFromCells(unsigned int index, const CellRange& range);
+    int cellIndex(int x, int y, int z) const;
+
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    float cellSize;
+    float inverseCellSize;
+    float margin;
+    int dims[3];
+
+    std::vector<std::vector<unsigned int>> cells;
+    std::vector<unsigned int> overflow;
+    std::vector<CellRange> ranges;
+};
+
+#endif // TARGET_GRID_H
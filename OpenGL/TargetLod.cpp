@@ -0,0 +1,87 @@
+#include "TargetLod.h"
+#include <cmath>
+
+// Thresholds keep the silhouette error, r * (1 - cos(pi / sectors)), under
+// about one pixel on a 600-pixel-high view. Frequencies are the smallest
+// whose Sphere::meshError is no larger than the UV level's.
+const SphereLod TargetLodRenderer::LEVELS[TargetLodRenderer::LEVEL_COUNT] = {
+    { 8, 4, 2, 0.0f },
+    { 16, 8, 3, 0.04f },
+    { 32, 16, 6, 0.17f },
+    { 64, 32, 11, 0.7f }
+};
+
+const float TargetLodRenderer::HYSTERESIS = 0.8f;
+
+TargetLodRenderer::TargetLodRenderer(SphereShape shape)
+    : shape(shape) {
+    for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+        if (shape == SPHERE_SHAPE_ICO) {
+            levels[i].reset(new TargetRenderer(Sphere::acquireIcoMesh(LEVELS[i].frequency)));
+        }
+        else {
+            levels[i].reset(new TargetRenderer(LEVELS[i].sectors, LEVELS[i].stacks));
+        }
+    }
+}
+
+SphereShape TargetLodRenderer::getShape() const {
+    return shape;
+}
+
+float TargetLodRenderer::screenSize(const glm::vec3& center, float radius, const glm::vec3& cameraPos,
+    float projectionScale) {
+    float distance = glm::length(center - cameraPos);
+    if (distance <= radius) {
+        return INFINITY; // camera inside the target
+    }
+    return radius * projectionScale / distance;
+}
+
+unsigned char TargetLodRenderer::selectLevel(float screenSize, unsigned char previous) {
+    unsigned int level = previous < LEVEL_COUNT ? previous : 0;
+    while (level + 1 < LEVEL_COUNT && screenSize > LEVELS[level + 1].minScreenSize) {
+        ++level;
+    }
+    while (level > 0 && screenSize < LEVELS[level].minScreenSize * HYSTERESIS) {
+        --level;
+    }
+    return (unsigned char)level;
+}
+
+void TargetLodRenderer::update(const std::vector<Sphere>& spheres, const std::vector<unsigned int>& visible,
+    const glm::vec3& cameraPos, float projectionScale) {
+    // New targets start at the coarsest level and climb in the same call
+    targetLevels.resize(spheres.size(), 0);
+
+    for (auto& targets : levelTargets) {
+        targets.clear();
+    }
+    for (unsigned int index : visible) {
+        const Sphere& sphere = spheres[index];
+        float size = screenSize(sphere.getPosition(), sphere.getRadius(), cameraPos, projectionScale);
+        unsigned char level = selectLevel(size, targetLevels[index]);
+        targetLevels[index] = level;
+        levelTargets[level].push_back(index);
+    }
+
+    for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+        levels[i]->update(spheres, levelTargets[i]);
+    }
+}
+
+const TargetRenderer& TargetLodRenderer::getLevel(size_t level) const {
+    return *levels[level];
+}
+
+const std::vector<unsigned char>& TargetLodRenderer::getTargetLevels() const {
+    return targetLevels;
+}
+
+size_t TargetLodRenderer::getTriangleCount() const {
+    size_t triangles = 0;
+    for (const auto& level : levels) {
+        triangles += level->getInstanceCount() * level->getIndexCount() / 3;
+    }
+    return triangles;
+}
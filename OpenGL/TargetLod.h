@@ -0,0 +1,65 @@
+#ifndef TARGET_LOD_H
+#define TARGET_LOD_H
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "Sphere.h"
+#include "TargetRenderer.h"
+
+// One detail level of the target mesh. frequency is the icosphere with no
+// more silhouette error than the sectors x stacks UV sphere. minScreenSize is
+// the projected radius, as a fraction of half the viewport height, above
+// which the level is used.
+struct SphereLod {
+    unsigned int sectors;
+    unsigned int stacks;
+    unsigned int frequency;
+    float minScreenSize;
+};
+
+// Draws targets with one instanced TargetRenderer per detail level, from
+// 8x4 for a few pixels up to 64x32 for a target filling the view, or the
+// icospheres of the same silhouette error. A target
+// only drops to a coarser level once it is HYSTERESIS times smaller than
+// the threshold that raised it, so levels don't flicker at a boundary.
+class TargetLodRenderer {
+public:
+    static const size_t LEVEL_COUNT = 4;
+    static const SphereLod LEVELS[LEVEL_COUNT];
+    static const float HYSTERESIS;
+
+    explicit TargetLodRenderer(SphereShape shape = SPHERE_SHAPE_UV);
+
+    SphereShape getShape() const;
+
+    // Projected radius of a sphere as a fraction of half the viewport
+    // height; projectionScale is projection[1][1]
+    static float screenSize(const glm::vec3& center, float radius, const glm::vec3& cameraPos,
+        float projectionScale);
+
+    // Level for a target of the given screen size; previous is the level it
+    // was drawn at last frame, used for hysteresis
+    static unsigned char selectLevel(float screenSize, unsigned char previous);
+
+    // Picks the level of every visible target and fills each level's
+    // instance buffer; levels of hidden targets are kept for when they return
+    void update(const std::vector<Sphere>& spheres, const std::vector<unsigned int>& visible,
+        const glm::vec3& cameraPos, float projectionScale);
+
+    const TargetRenderer& getLevel(size_t level) const;
+
+    // Level each target was last drawn at, indexed like spheres
+    const std::vector<unsigned char>& getTargetLevels() const;
+
+    // Triangles the levels draw with the current instances
+    size_t getTriangleCount() const;
+
+private:
+    SphereShape shape;
+    std::unique_ptr<TargetRenderer> levels[LEVEL_COUNT];
+    std::vector<unsigned int> levelTargets[LEVEL_COUNT];
+    std::vector<unsigned char> targetLevels;
+};
+
+#endif // TARGET_LOD_H
@@ -0,0 +1,110 @@
+#include "TargetRenderer.h"
+#include <algorithm>
+#include <cstring>
+
+TargetRenderer::TargetRenderer(unsigned int sectors, unsigned int stacks)
+    : TargetRenderer(Sphere::acquireMesh(sectors, stacks)) {
+}
+
+TargetRenderer::TargetRenderer(std::shared_ptr<SphereMesh> sharedMesh)
+    : mesh(sharedMesh), VAO(0), instanceVBO(0), capacity(0), uploadedBytes(0) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceVBO);
+
+    glBindVertexArray(VAO);
+
+    // Unit sphere (or quad) positions and indices from the shared mesh
+    mesh->bindAttributes();
+
+    // Center/radius and color advance once per instance
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(SPHERE_CENTER_RADIUS_ATTRIB, 4, GL_FLOAT, GL_FALSE, sizeof(TargetInstance),
+        (void*)offsetof(TargetInstance, centerRadius));
+    glEnableVertexAttribArray(SPHERE_CENTER_RADIUS_ATTRIB);
+    glVertexAttribDivisor(SPHERE_CENTER_RADIUS_ATTRIB, 1);
+    glVertexAttribPointer(SPHERE_COLOR_ATTRIB, 3, GL_FLOAT, GL_FALSE, sizeof(TargetInstance),
+        (void*)offsetof(TargetInstance, color));
+    glEnableVertexAttribArray(SPHERE_COLOR_ATTRIB);
+    glVertexAttribDivisor(SPHERE_COLOR_ATTRIB, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+TargetRenderer::~TargetRenderer() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &instanceVBO);
+}
+
+void TargetRenderer::update(const std::vector<Sphere>& spheres) {
+    updateInstances(spheres, nullptr, spheres.size());
+}
+
+void TargetRenderer::update(const std::vector<Sphere>& spheres, const std::vector<unsigned int>& visible) {
+    updateInstances(spheres, visible.data(), visible.size());
+}
+
+void TargetRenderer::updateInstances(const std::vector<Sphere>& spheres, const unsigned int* indices,
+    size_t count) {
+    uploadedBytes = 0;
+    bool resized = count != instances.size();
+    instances.resize(count);
+
+    // Find the range of instances that changed since the last upload
+    size_t first = count;
+    size_t last = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Sphere& sphere = spheres[indices ? indices[i] : i];
+        TargetInstance instance;
+        instance.centerRadius = glm::vec4(sphere.getPosition(), sphere.getRadius());
+        instance.color = glm::vec4(sphere.getColor(), 1.0f);
+        if (resized || std::memcmp(&instance, &instances[i], sizeof(TargetInstance)) != 0) {
+            instances[i] = instance;
+            first = std::min(first, i);
+            last = i + 1;
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (count > capacity) {
+        // Grow geometrically so adding targets does not reallocate every frame
+        capacity = std::max(count, capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(TargetInstance), nullptr, GL_DYNAMIC_DRAW);
+        first = 0;
+        last = count;
+    }
+    if (first < last) {
+        uploadedBytes = (last - first) * sizeof(TargetInstance);
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(TargetInstance), uploadedBytes, &instances[first]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TargetRenderer::render() const {
+    if (instances.empty()) {
+        return;
+    }
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, mesh->indexCount, mesh->indexType, 0, (GLsizei)instances.size());
+    glBindVertexArray(0);
+}
+
+size_t TargetRenderer::getInstanceCount() const {
+    return instances.size();
+}
+
+unsigned int TargetRenderer::getVAO() const {
+    return VAO;
+}
+
+size_t TargetRenderer::getIndexCount() const {
+    return mesh->indexCount;
+}
+
+unsigned int TargetRenderer::getIndexType() const {
+    return mesh->indexType;
+}
+
+size_t TargetRenderer::getUploadedBytes() const {
+    return uploadedBytes;
+}
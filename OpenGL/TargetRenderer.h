@@ -0,0 +1,59 @@
+#ifndef TARGET_RENDERER_H
+#define TARGET_RENDERER_H
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "Sphere.h"
+
+// Per-instance data read by sphereVertexShaderSource (locations 2 and 3)
+struct TargetInstance {
+    glm::vec4 centerRadius;
+    glm::vec4 color;
+};
+
+// Draws every target with one glDrawElementsInstanced over the shared
+// unit-sphere mesh. Instance data is mirrored on the CPU and only the
+// changed range is uploaded, so a respawn costs one instance worth of bytes.
+class TargetRenderer {
+public:
+    TargetRenderer(unsigned int sectors = 36, unsigned int stacks = 18);
+
+    // Draws every instance with the given shared mesh, e.g. the impostor quad
+    explicit TargetRenderer(std::shared_ptr<SphereMesh> sharedMesh);
+
+    // Destructor to clean up OpenGL resources
+    ~TargetRenderer();
+
+    // Copies the spheres' placement and color into the instance buffer
+    void update(const std::vector<Sphere>& spheres);
+
+    // Same, for only the spheres listed in visible (e.g. after frustum culling)
+    void update(const std::vector<Sphere>& spheres, const std::vector<unsigned int>& visible);
+
+    // Draws all instances; the program and its uniforms must already be set
+    void render() const;
+
+    size_t getInstanceCount() const;
+
+    // Vertex array, index count and index type of the instanced draw, for the render queue
+    unsigned int getVAO() const;
+    size_t getIndexCount() const;
+    unsigned int getIndexType() const;
+
+    // Bytes sent to the instance buffer by the last update
+    size_t getUploadedBytes() const;
+
+private:
+    // Instances are built from spheres[indices[i]], or spheres[i] when indices is null
+    void updateInstances(const std::vector<Sphere>& spheres, const unsigned int* indices, size_t count);
+
+    std::shared_ptr<SphereMesh> mesh;
+    unsigned int VAO;
+    unsigned int instanceVBO;
+    size_t capacity;
+    size_t uploadedBytes;
+    std::vector<TargetInstance> instances;
+};
+
+#endif // TARGET_RENDERER_H
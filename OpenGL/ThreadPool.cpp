@@ -0,0 +1,90 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : task(nullptr), taskCount(0), nextTask(0), generation(0), busy(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    for (unsigned int i = 1; i < threadCount; ++i) {
+        workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)>& function) {
+    if (workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+
+    {
+        // A worker that woke too late for the previous run may still be
+        // looking at its counter
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return busy == 0; });
+        task = &function;
+        taskCount = count;
+        nextTask = 0;
+        ++generation;
+    }
+    wake.notify_all();
+
+    for (size_t i = nextTask++; i < count; i = nextTask++) {
+        function(i);
+    }
+
+    // Every task is claimed; wait for the ones still running elsewhere
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return busy == 0; });
+    task = nullptr;
+}
+
+unsigned int ThreadPool::getThreadCount() const {
+    return (unsigned int)workers.size() + 1;
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::work() {
+    unsigned long long seen = 0;
+    while (true) {
+        const std::function<void(size_t)>* function;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            function = task;
+            count = taskCount;
+            ++busy;
+        }
+
+        for (size_t i = nextTask++; i < count; i = nextTask++) {
+            (*function)(i);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busy;
+        }
+        finished.notify_all();
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for splitting load-time work into tasks.
+// The calling thread works too, so a pool of one runs everything inline.
+class ThreadPool {
+public:
+    // threadCount includes the caller; 0 uses one per hardware thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls function(i) for every i below count, spread over the pool, and
+    // returns once all calls have finished. One run at a time per pool.
+    void run(size_t count, const std::function<void(size_t)>& function);
+
+    unsigned int getThreadCount() const;
+
+    // Pool shared by loaders, started on first use
+    static ThreadPool& shared();
+
+private:
+    void work();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+
+    // Current run; workers copy these under the mutex
+    const std::function<void(size_t)>* task;
+    size_t taskCount;
+    std::atomic<size_t> nextTask;
+    unsigned long long generation;
+    unsigned int busy; // workers inside the current run
+    bool stopping;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,352 @@
+#include "TransformSystem.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRANSFORM_SYSTEM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const size_t LANES = 4;
+
+// Float stride between consecutive instances
+const size_t INSTANCE_FLOATS = sizeof(TransformInstance) / sizeof(float);
+
+#ifdef TRANSFORM_SYSTEM_SSE2
+
+// Transposes four lane-major registers into four object-major columns and
+// stores them at the given float offset of consecutive instances
+inline void storeColumns(__m128 x, __m128 y, __m128 z, __m128 w, float* base, size_t lanes) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    const __m128 columns[LANES] = { x, y, z, w };
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        _mm_storeu_ps(base + lane * INSTANCE_FLOATS, columns[lane]);
+    }
+}
+
+#endif // TRANSFORM_SYSTEM_SSE2
+
+} // namespace
+
+TransformSystem::TransformSystem()
+    : count(0), lastViewProj(1.0f), hasViewProj(false), changedFirst(0), changedLast(0),
+    instanceVBO(0), capacity(0), uploadedBytes(0) {
+}
+
+TransformSystem::~TransformSystem() {
+    if (instanceVBO != 0) {
+        glDeleteBuffers(1, &instanceVBO);
+    }
+}
+
+size_t TransformSystem::add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    size_t index = count++;
+    if (index == positionX.size()) {
+        // Grow by a whole block of identity transforms so SIMD loads stay in bounds
+        size_t padded = index + LANES;
+        positionX.resize(padded, 0.0f);
+        positionY.resize(padded, 0.0f);
+        positionZ.resize(padded, 0.0f);
+        rotationX.resize(padded, 0.0f);
+        rotationY.resize(padded, 0.0f);
+        rotationZ.resize(padded, 0.0f);
+        rotationW.resize(padded, 1.0f);
+        scaleX.resize(padded, 1.0f);
+        scaleY.resize(padded, 1.0f);
+        scaleZ.resize(padded, 1.0f);
+        dirty.resize(padded, 0);
+    }
+
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+    rotationX[index] = rotation.x;
+    rotationY[index] = rotation.y;
+    rotationZ[index] = rotation.z;
+    rotationW[index] = rotation.w;
+    scaleX[index] = scale.x;
+    scaleY[index] = scale.y;
+    scaleZ[index] = scale.z;
+    dirty[index] = 1;
+
+    instances.push_back(TransformInstance());
+    return index;
+}
+
+void TransformSystem::setPosition(size_t index, const glm::vec3& position) {
+    if (positionX[index] == position.x && positionY[index] == position.y && positionZ[index] == position.z) {
+        return;
+    }
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+    dirty[index] = 1;
+}
+
+void TransformSystem::setRotation(size_t index, const glm::quat& rotation) {
+    if (rotationX[index] == rotation.x && rotationY[index] == rotation.y &&
+        rotationZ[index] == rotation.z && rotationW[index] == rotation.w) {
+        return;
+    }
+    rotationX[index] = rotation.x;
+    rotationY[index] = rotation.y;
+    rotationZ[index] = rotation.z;
+    rotationW[index] = rotation.w;
+    dirty[index] = 1;
+}
+
+void TransformSystem::setScale(size_t index, const glm::vec3& scale) {
+    if (scaleX[index] == scale.x && scaleY[index] == scale.y && scaleZ[index] == scale.z) {
+        return;
+    }
+    scaleX[index] = scale.x;
+    scaleY[index] = scale.y;
+    scaleZ[index] = scale.z;
+    dirty[index] = 1;
+}
+
+bool TransformSystem::viewProjChanged(const glm::mat4& viewProj) {
+    bool changed = !hasViewProj || std::memcmp(&viewProj, &lastViewProj, sizeof(glm::mat4)) != 0;
+    lastViewProj = viewProj;
+    hasViewProj = true;
+    return changed;
+}
+
+void TransformSystem::markChanged(size_t index) {
+    if (changedFirst == changedLast) {
+        changedFirst = index;
+        changedLast = index + 1;
+    }
+    else {
+        changedFirst = std::min(changedFirst, index);
+        changedLast = std::max(changedLast, index + 1);
+    }
+}
+
+size_t TransformSystem::update(const glm::mat4& viewProj) {
+#ifdef TRANSFORM_SYSTEM_SSE2
+    bool all = viewProjChanged(viewProj);
+    size_t recomputed = 0;
+    for (size_t first = 0; first < count; first += LANES) {
+        if (!all && !(dirty[first] | dirty[first + 1] | dirty[first + 2] | dirty[first + 3])) {
+            continue;
+        }
+        computeBlock(first, viewProj);
+        size_t lanes = std::min(LANES, count - first);
+        std::memset(&dirty[first], 0, LANES);
+        markChanged(first);
+        markChanged(first + lanes - 1);
+        recomputed += lanes;
+    }
+    return recomputed;
+#else
+    return updateScalar(viewProj);
+#endif
+}
+
+size_t TransformSystem::updateScalar(const glm::mat4& viewProj) {
+    bool all = viewProjChanged(viewProj);
+    size_t recomputed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!all && !dirty[i]) {
+            continue;
+        }
+        computeScalar(i, viewProj);
+        dirty[i] = 0;
+        markChanged(i);
+        ++recomputed;
+    }
+    return recomputed;
+}
+
+void TransformSystem::computeScalar(size_t i, const glm::mat4& vp) {
+    // Rotation from the quaternion, as glm::mat4_cast
+    float x = rotationX[i], y = rotationY[i], z = rotationZ[i], w = rotationW[i];
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+    glm::vec3 r0(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+    glm::vec3 r1(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+    glm::vec3 r2(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+
+    // world = T * R * S
+    glm::vec3 c0 = r0 * scaleX[i];
+    glm::vec3 c1 = r1 * scaleY[i];
+    glm::vec3 c2 = r2 * scaleZ[i];
+    glm::vec3 c3(positionX[i], positionY[i], positionZ[i]);
+
+    TransformInstance& instance = instances[i];
+    instance.world[0] = glm::vec4(c0, 0.0f);
+    instance.world[1] = glm::vec4(c1, 0.0f);
+    instance.world[2] = glm::vec4(c2, 0.0f);
+    instance.world[3] = glm::vec4(c3, 1.0f);
+
+    // Inverse transpose of R * S is R * S^-1
+    instance.normal[0] = glm::vec4(r0 * (1.0f / scaleX[i]), 0.0f);
+    instance.normal[1] = glm::vec4(r1 * (1.0f / scaleY[i]), 0.0f);
+    instance.normal[2] = glm::vec4(r2 * (1.0f / scaleZ[i]), 0.0f);
+
+    // mvp = viewProj * world, written out in the same order as the SIMD path
+    for (int row = 0; row < 4; ++row) {
+        instance.mvp[0][row] = vp[0][row] * c0.x + vp[1][row] * c0.y + vp[2][row] * c0.z;
+        instance.mvp[1][row] = vp[0][row] * c1.x + vp[1][row] * c1.y + vp[2][row] * c1.z;
+        instance.mvp[2][row] = vp[0][row] * c2.x + vp[1][row] * c2.y + vp[2][row] * c2.z;
+        instance.mvp[3][row] = vp[0][row] * c3.x + vp[1][row] * c3.y + vp[2][row] * c3.z + vp[3][row];
+    }
+}
+
+void TransformSystem::computeBlock(size_t first, const glm::mat4& vp) {
+#ifdef TRANSFORM_SYSTEM_SSE2
+    // Each register holds one matrix element for four consecutive objects
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+
+    __m128 x = _mm_loadu_ps(&rotationX[first]);
+    __m128 y = _mm_loadu_ps(&rotationY[first]);
+    __m128 z = _mm_loadu_ps(&rotationZ[first]);
+    __m128 w = _mm_loadu_ps(&rotationW[first]);
+    __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+    __m128 r00 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+    __m128 r01 = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+    __m128 r02 = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+    __m128 r10 = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+    __m128 r11 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+    __m128 r12 = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+    __m128 r20 = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+    __m128 r21 = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+    __m128 r22 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+    __m128 sx = _mm_loadu_ps(&scaleX[first]);
+    __m128 sy = _mm_loadu_ps(&scaleY[first]);
+    __m128 sz = _mm_loadu_ps(&scaleZ[first]);
+
+    // world columns
+    __m128 c0x = _mm_mul_ps(r00, sx), c0y = _mm_mul_ps(r01, sx), c0z = _mm_mul_ps(r02, sx);
+    __m128 c1x = _mm_mul_ps(r10, sy), c1y = _mm_mul_ps(r11, sy), c1z = _mm_mul_ps(r12, sy);
+    __m128 c2x = _mm_mul_ps(r20, sz), c2y = _mm_mul_ps(r21, sz), c2z = _mm_mul_ps(r22, sz);
+    __m128 c3x = _mm_loadu_ps(&positionX[first]);
+    __m128 c3y = _mm_loadu_ps(&positionY[first]);
+    __m128 c3z = _mm_loadu_ps(&positionZ[first]);
+
+    size_t lanes = std::min(LANES, count - first);
+    float* base = reinterpret_cast<float*>(&instances[first]);
+    float* world = base + offsetof(TransformInstance, world) / sizeof(float);
+    float* mvp = base + offsetof(TransformInstance, mvp) / sizeof(float);
+    float* normal = base + offsetof(TransformInstance, normal) / sizeof(float);
+
+    storeColumns(c0x, c0y, c0z, zero, world, lanes);
+    storeColumns(c1x, c1y, c1z, zero, world + 4, lanes);
+    storeColumns(c2x, c2y, c2z, zero, world + 8, lanes);
+    storeColumns(c3x, c3y, c3z, one, world + 12, lanes);
+
+    // Normal matrix columns R * S^-1
+    __m128 isx = _mm_div_ps(one, sx), isy = _mm_div_ps(one, sy), isz = _mm_div_ps(one, sz);
+    storeColumns(_mm_mul_ps(r00, isx), _mm_mul_ps(r01, isx), _mm_mul_ps(r02, isx), zero, normal, lanes);
+    storeColumns(_mm_mul_ps(r10, isy), _mm_mul_ps(r11, isy), _mm_mul_ps(r12, isy), zero, normal + 4, lanes);
+    storeColumns(_mm_mul_ps(r20, isz), _mm_mul_ps(r21, isz), _mm_mul_ps(r22, isz), zero, normal + 8, lanes);
+
+    // mvp = viewProj * world with viewProj broadcast across the lanes
+    __m128 m[4][4];
+    for (int row = 0; row < 4; ++row) {
+        __m128 v0 = _mm_set1_ps(vp[0][row]);
+        __m128 v1 = _mm_set1_ps(vp[1][row]);
+        __m128 v2 = _mm_set1_ps(vp[2][row]);
+        __m128 v3 = _mm_set1_ps(vp[3][row]);
+        m[0][row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v0, c0x), _mm_mul_ps(v1, c0y)), _mm_mul_ps(v2, c0z));
+        m[1][row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v0, c1x), _mm_mul_ps(v1, c1y)), _mm_mul_ps(v2, c1z));
+        m[2][row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v0, c2x), _mm_mul_ps(v1, c2y)), _mm_mul_ps(v2, c2z));
+        m[3][row] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(v0, c3x), _mm_mul_ps(v1, c3y)),
+            _mm_mul_ps(v2, c3z)), v3);
+    }
+    for (int column = 0; column < 4; ++column) {
+        storeColumns(m[column][0], m[column][1], m[column][2], m[column][3], mvp + 4 * column, lanes);
+    }
+#else
+    for (size_t i = first; i < std::min(first + LANES, count); ++i) {
+        computeScalar(i, vp);
+    }
+#endif
+}
+
+const TransformInstance& TransformSystem::get(size_t index) const {
+    return instances[index];
+}
+
+const TransformInstance* TransformSystem::data() const {
+    return instances.data();
+}
+
+size_t TransformSystem::size() const {
+    return count;
+}
+
+void TransformSystem::upload() {
+    uploadedBytes = 0;
+    size_t first = changedFirst;
+    size_t last = changedLast;
+    changedFirst = changedLast = 0;
+
+    if (instanceVBO == 0) {
+        glGenBuffers(1, &instanceVBO);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (count > capacity) {
+        // Grow geometrically so adding objects does not reallocate every frame
+        capacity = std::max(count, capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(TransformInstance), nullptr, GL_DYNAMIC_DRAW);
+        first = 0;
+        last = count;
+    }
+    if (first < last) {
+        uploadedBytes = (last - first) * sizeof(TransformInstance);
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(TransformInstance), uploadedBytes, &instances[first]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+unsigned int TransformSystem::getInstanceBuffer() const {
+    return instanceVBO;
+}
+
+void TransformSystem::bindAttributes(unsigned int vertexArray, size_t index) const {
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // Every draw reads instance 0, so the object is picked by the offset
+    size_t base = index * sizeof(TransformInstance);
+    for (unsigned int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(TRANSFORM_WORLD_ATTRIB + column, 4, GL_FLOAT, GL_FALSE, sizeof(TransformInstance),
+            (void*)(base + offsetof(TransformInstance, world) + column * sizeof(glm::vec4)));
+        glVertexAttribPointer(TRANSFORM_MVP_ATTRIB + column, 4, GL_FLOAT, GL_FALSE, sizeof(TransformInstance),
+            (void*)(base + offsetof(TransformInstance, mvp) + column * sizeof(glm::vec4)));
+    }
+    for (unsigned int column = 0; column < 3; ++column) {
+        glVertexAttribPointer(TRANSFORM_NORMAL_ATTRIB + column, 3, GL_FLOAT, GL_FALSE, sizeof(TransformInstance),
+            (void*)(base + offsetof(TransformInstance, normal) + column * sizeof(glm::vec4)));
+    }
+    for (unsigned int slot = TRANSFORM_WORLD_ATTRIB; slot < TRANSFORM_NORMAL_ATTRIB + 3; ++slot) {
+        glEnableVertexAttribArray(slot);
+        glVertexAttribDivisor(slot, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t TransformSystem::getUploadedBytes() const {
+    return uploadedBytes;
+}
+
+const char* TransformSystem::kernel() {
+#ifdef TRANSFORM_SYSTEM_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,103 @@
+#ifndef TRANSFORM_SYSTEM_H
+#define TRANSFORM_SYSTEM_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+// Vertex attribute slots for the per-instance matrices (see modelVertexShaderSource);
+// each mat4 takes four slots and the normal matrix three
+#define TRANSFORM_WORLD_ATTRIB 3
+#define TRANSFORM_MVP_ATTRIB 7
+#define TRANSFORM_NORMAL_ATTRIB 11
+
+// Matrices of one object, laid out as vec4 columns so the array can be used
+// directly as a per-instance vertex buffer
+struct TransformInstance {
+    glm::mat4 world;
+    glm::mat4 mvp;
+    glm::vec4 normal[3]; // normal matrix columns, w unused
+};
+
+// Object transforms stored as structure-of-arrays with a dirty flag each.
+// update() rebuilds world = T * R * S, the normal matrix R * S^-1 and
+// mvp = viewProj * world for four objects per step (SSE2 where available),
+// touching only blocks with a dirty object unless viewProj changed.
+class TransformSystem {
+public:
+    TransformSystem();
+
+    // Destructor to clean up OpenGL resources
+    ~TransformSystem();
+
+    TransformSystem(const TransformSystem&) = delete;
+    TransformSystem& operator=(const TransformSystem&) = delete;
+
+    // Appends an object and returns its index
+    size_t add(const glm::vec3& position = glm::vec3(0.0f),
+        const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+        const glm::vec3& scale = glm::vec3(1.0f));
+
+    // Setters mark the object dirty only when the value changes
+    void setPosition(size_t index, const glm::vec3& position);
+    void setRotation(size_t index, const glm::quat& rotation);
+    void setScale(size_t index, const glm::vec3& scale);
+
+    // Recomputes the matrices of dirty objects, or of every object when
+    // viewProj differs from the last call; returns the number recomputed
+    size_t update(const glm::mat4& viewProj);
+
+    // Same as update() without SIMD, used as the reference
+    size_t updateScalar(const glm::mat4& viewProj);
+
+    const TransformInstance& get(size_t index) const;
+    const TransformInstance* data() const;
+    size_t size() const;
+
+    // Copies the instances recomputed since the last upload into the instance
+    // buffer (created on first use)
+    void upload();
+    unsigned int getInstanceBuffer() const;
+
+    // Points the TRANSFORM_*_ATTRIB slots of a vertex array at one object's
+    // matrices in the instance buffer. Call after the first upload; the
+    // binding survives later uploads and growth.
+    void bindAttributes(unsigned int vertexArray, size_t index) const;
+
+    // Bytes sent to the instance buffer by the last upload
+    size_t getUploadedBytes() const;
+
+    // Name of the kernel update() uses ("sse2" or "scalar")
+    static const char* kernel();
+
+private:
+    // Stores viewProj and returns true when it differs from the last update
+    bool viewProjChanged(const glm::mat4& viewProj);
+
+    // Extends the range of instances the next upload() sends
+    void markChanged(size_t index);
+
+    void computeScalar(size_t index, const glm::mat4& viewProj);
+    void computeBlock(size_t first, const glm::mat4& viewProj);
+
+    // Padded to a multiple of four with identity transforms
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<unsigned char> dirty;
+    size_t count;
+
+    std::vector<TransformInstance> instances;
+    glm::mat4 lastViewProj;
+    bool hasViewProj;
+
+    // Instances changed since the last upload
+    size_t changedFirst;
+    size_t changedLast;
+
+    unsigned int instanceVBO;
+    size_t capacity;
+    size_t uploadedBytes;
+};
+
+#endif // TRANSFORM_SYSTEM_H
@@ -0,0 +1,43 @@
+#include "UniformBuffer.h"
+#include <glad/glad.h>
+#include <cstring>
+
+UniformBuffer::UniformBuffer(size_t size, unsigned int binding)
+    : UBO(0), binding(binding), hasData(false), contents(size), uploadCount(0), skippedCount(0) {
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)size, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+}
+
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &UBO);
+}
+
+bool UniformBuffer::upload(const void* data) {
+    if (hasData && std::memcmp(contents.data(), data, contents.size()) == 0) {
+        ++skippedCount;
+        return false;
+    }
+    std::memcpy(contents.data(), data, contents.size());
+    hasData = true;
+    ++uploadCount;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)contents.size(), contents.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
+
+unsigned int UniformBuffer::getBinding() const {
+    return binding;
+}
+
+size_t UniformBuffer::getUploadCount() const {
+    return uploadCount;
+}
+
+size_t UniformBuffer::getSkippedCount() const {
+    return skippedCount;
+}
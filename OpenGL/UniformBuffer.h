@@ -0,0 +1,39 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+// A fixed-size uniform buffer kept bound at one binding point. The last
+// upload is mirrored on the CPU, so writing the same contents again is
+// skipped and a changed block costs a single glBufferSubData.
+class UniformBuffer {
+public:
+    UniformBuffer(size_t size, unsigned int binding);
+
+    // Destructor to clean up OpenGL resources
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // Uploads size bytes from data unless they match the last upload;
+    // returns true when an upload was issued
+    bool upload(const void* data);
+
+    unsigned int getBinding() const;
+
+    // Uploads issued and skipped because the contents were unchanged
+    size_t getUploadCount() const;
+    size_t getSkippedCount() const;
+
+private:
+    unsigned int UBO;
+    unsigned int binding;
+    bool hasData;
+    std::vector<unsigned char> contents;
+    size_t uploadCount;
+    size_t skippedCount;
+};
+
+#endif // UNIFORM_BUFFER_H